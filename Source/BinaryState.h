@@ -0,0 +1,80 @@
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+#include <array>
+
+// The plugin state as a fixed table of parameter values instead of the parameter tree's XML, so
+// saving and loading a session with many instances skips building and parsing XML. All little
+// endian:
+//   uint32  magic "UCst"
+//   uint32  version
+//   uint32  count
+//   float   count plain (not normalised) values, in parameterIds order
+// New parameters are appended to the table: an older state has a smaller count and leaves them
+// at their defaults, a newer one has a larger count and its extra values are ignored. Only a
+// change of what an existing entry means bumps the version.
+class BinaryState {
+ public:
+  static constexpr juce::uint32 magic = 0x74734355;  // "UCst"
+  static constexpr juce::uint32 version = 1;
+
+  // never reorder or remove an entry
+  static constexpr std::array<const char*, 15> parameterIds{
+      "gain",
+      "invertPhaseL",
+      "invertPhaseR",
+      "channelMode",
+      "mono",
+      "pan",
+      "stereoMode",
+      "stereoWidth",
+      "stereoMidSide",
+      "isBassMono",
+      "bassMonoFrequency",
+      "isBassMonoListening",
+      "isDc",
+      "isBassMonoLinearPhase",
+      "bassMonoSlope",
+  };
+
+  explicit BinaryState(juce::AudioProcessorValueTreeState& state) {
+    for (size_t i = 0; i < parameterIds.size(); ++i) {
+      parameters[i] = state.getParameter(parameterIds[i]);
+      jassert(parameters[i] != nullptr);
+    }
+  }
+
+  void write(juce::MemoryBlock& destData) const {
+    juce::MemoryOutputStream stream(destData, false);
+    stream.writeInt(static_cast<int>(magic));
+    stream.writeInt(static_cast<int>(version));
+    stream.writeInt(static_cast<int>(parameters.size()));
+    for (const auto* parameter : parameters)
+      stream.writeFloat(parameter->convertFrom0to1(parameter->getValue()));
+  }
+
+  // false, without touching a parameter, for anything else (e.g. the former XML state) or a
+  // version this build does not know
+  bool read(const void* data, int sizeInBytes) const {
+    constexpr int headerSize = 3 * 4;
+    if (data == nullptr || sizeInBytes < headerSize) return false;
+
+    juce::MemoryInputStream stream(data, static_cast<size_t>(sizeInBytes), false);
+    if (static_cast<juce::uint32>(stream.readInt()) != magic) return false;
+    if (static_cast<juce::uint32>(stream.readInt()) > version) return false;
+    const int count = stream.readInt();
+    if (count < 0 || count > (sizeInBytes - headerSize) / 4) return false;
+
+    for (size_t i = 0; i < parameters.size(); ++i) {
+      auto* parameter = parameters[i];
+      parameter->setValueNotifyingHost(static_cast<int>(i) < count
+                                           ? parameter->convertTo0to1(stream.readFloat())
+                                           : parameter->getDefaultValue());
+    }
+    return true;
+  }
+
+ private:
+  std::array<juce::RangedAudioParameter*, parameterIds.size()> parameters{};
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include <utility>
+
+// How a bus is split for processing. Pairs get every control (phase L/R, channel mode, width,
+// mono, bass mono, pan); single channels only get phase L, gain and DC.
+//   - mono / stereo / discrete layouts: consecutive channels are paired, an odd last one is single
+//   - named surround layouts: matching left/right speakers are paired (L/R, Ls/Rs, Ltf/Rtf...),
+//     centre, LFE and other unmatched speakers are single
+//   - ambisonic layouts: every channel is single, width and pan have no meaning on them
+struct ChannelGroups {
+  static constexpr int maxChannels = 64;
+
+  struct Pair {
+    int left;
+    int right;
+  };
+
+  std::array<Pair, maxChannels / 2> pairs{};
+  int numPairs = 0;
+  std::array<int, maxChannels> singles{};
+  int numSingles = 0;
+
+  static ChannelGroups fromLayout(const juce::AudioChannelSet& layout) {
+    using Type = juce::AudioChannelSet::ChannelType;
+    ChannelGroups groups;
+    const int numChannels = juce::jmin(layout.size(), maxChannels);
+
+    if (layout.isDiscreteLayout() || layout == juce::AudioChannelSet::stereo() ||
+        layout == juce::AudioChannelSet::mono()) {
+      for (int channel = 0; channel + 1 < numChannels; channel += 2)
+        groups.pairs[groups.numPairs++] = {channel, channel + 1};
+      if (numChannels % 2 != 0) groups.singles[groups.numSingles++] = numChannels - 1;
+      return groups;
+    }
+
+    constexpr std::array<std::pair<Type, Type>, 9> speakerPairs{{
+        {Type::left, Type::right},
+        {Type::leftCentre, Type::rightCentre},
+        {Type::leftSurround, Type::rightSurround},
+        {Type::leftSurroundSide, Type::rightSurroundSide},
+        {Type::leftSurroundRear, Type::rightSurroundRear},
+        {Type::wideLeft, Type::wideRight},
+        {Type::topFrontLeft, Type::topFrontRight},
+        {Type::topSideLeft, Type::topSideRight},
+        {Type::topRearLeft, Type::topRearRight},
+    }};
+
+    std::array<bool, maxChannels> isPaired{};
+    for (const auto& [leftType, rightType] : speakerPairs) {
+      const int left = layout.getChannelIndexForType(leftType);
+      const int right = layout.getChannelIndexForType(rightType);
+      if (left < 0 || right < 0 || left >= numChannels || right >= numChannels) continue;
+      groups.pairs[groups.numPairs++] = {left, right};
+      isPaired[left] = isPaired[right] = true;
+    }
+
+    for (int channel = 0; channel < numChannels; ++channel)
+      if (!isPaired[channel]) groups.singles[groups.numSingles++] = channel;
+
+    return groups;
+  }
+};
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cmath>
+
+#include "ChannelGroups.h"
+#include "SimdDispatch.h"
+
+// Peak, RMS and L/R correlation of the input and the output. The audio thread measures every
+// block and publishes one Reading about 60 times a second through a wait-free single-producer /
+// single-consumer FIFO; the editor pops them on its timer. Nothing is measured while no editor
+// is open (setActive). A bus is metered on its first left/right pair, or its first channel twice.
+class LevelMeter {
+ public:
+  struct Levels {
+    float peakL = 0, peakR = 0;
+    float sumSquaresL = 0, sumSquaresR = 0, sumProducts = 0;
+    int numSamples = 0;
+
+    void merge(const Levels& other) {
+      peakL = juce::jmax(peakL, other.peakL);
+      peakR = juce::jmax(peakR, other.peakR);
+      sumSquaresL += other.sumSquaresL;
+      sumSquaresR += other.sumSquaresR;
+      sumProducts += other.sumProducts;
+      numSamples += other.numSamples;
+    }
+
+    float getRmsL() const { return numSamples > 0 ? std::sqrt(sumSquaresL / numSamples) : 0.0f; }
+    float getRmsR() const { return numSamples > 0 ? std::sqrt(sumSquaresR / numSamples) : 0.0f; }
+
+    // +1 mono, 0 unrelated, -1 out of phase; 0 when either side is silent
+    float getCorrelation() const {
+      const auto energy = std::sqrt(sumSquaresL * sumSquaresR);
+      return energy > 1.0e-12f ? juce::jlimit(-1.0f, 1.0f, sumProducts / energy) : 0.0f;
+    }
+  };
+
+  struct Reading {
+    Levels input, output;
+
+    void merge(const Reading& other) {
+      input.merge(other.input);
+      output.merge(other.output);
+    }
+  };
+
+  void prepare(double sampleRate) {
+    publishInterval = juce::jmax(1, static_cast<int>(sampleRate / 60.0));
+    pending = {};
+  }
+
+  // called by the editor, so the audio thread only measures while someone is looking
+  void setActive(bool shouldBeActive) { isActiveFlag = shouldBeActive; }
+  bool isActive() const { return isActiveFlag; }
+
+  //==============================================================================
+  // audio thread
+  template <typename SampleType>
+  void measureInput(const juce::AudioBuffer<SampleType>& buffer, const ChannelGroups& groups) {
+    measure(buffer, groups, pending.input);
+  }
+
+  template <typename SampleType>
+  void measureOutput(const juce::AudioBuffer<SampleType>& buffer, const ChannelGroups& groups) {
+    measure(buffer, groups, pending.output);
+    if (pending.output.numSamples < publishInterval) return;
+
+    // a full FIFO means the editor is behind; that reading is dropped
+    auto scope = fifo.write(1);
+    scope.forEach([this](int index) { readings[static_cast<size_t>(index)] = pending; });
+    pending = {};
+  }
+
+  //==============================================================================
+  // message thread: everything published since the last call, merged into one reading
+  bool pop(Reading& merged) {
+    const int numReady = fifo.getNumReady();
+    if (numReady == 0) return false;
+
+    merged = {};
+    auto scope = fifo.read(numReady);
+    scope.forEach([&](int index) { merged.merge(readings[static_cast<size_t>(index)]); });
+    return true;
+  }
+
+ private:
+  template <typename SampleType>
+  void measure(const juce::AudioBuffer<SampleType>& buffer, const ChannelGroups& groups,
+               Levels& levels) const {
+    int left = 0, right = 0;
+    if (groups.numPairs > 0) {
+      left = groups.pairs[0].left;
+      right = groups.pairs[0].right;
+    } else if (groups.numSingles > 0) {
+      left = right = groups.singles[0];
+    } else {
+      return;
+    }
+
+    const auto sums = SimdKernels<SampleType>::get(simdLevel)->measureLevels(
+        buffer.getReadPointer(left), buffer.getReadPointer(right), buffer.getNumSamples());
+    levels.merge({sums.peakL, sums.peakR, sums.sumSquaresL, sums.sumSquaresR, sums.sumProducts,
+                  buffer.getNumSamples()});
+  }
+
+  static constexpr int capacity = 32;  // about half a second of readings
+
+  const SimdLevel simdLevel = detectSimdLevel();
+  std::atomic<bool> isActiveFlag{false};
+  int publishInterval = 800;
+  Reading pending;  // audio thread only
+
+  juce::AbstractFifo fifo{capacity};
+  std::array<Reading, capacity> readings;
+};
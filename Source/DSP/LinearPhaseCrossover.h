@@ -0,0 +1,271 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "ChannelGroups.h"
+#include "PartitionedConvolver.h"
+
+// Kernels for every cutoff on a 1/24 octave grid over the parameter's 50 to 500 Hz, one set per
+// sample rate and slope, shared by every instance in the process. A few MB and a few thousand
+// FFTs each, so only the slopes in use are built, never on the audio thread
+// (LinearPhaseCrossover::loadSlope()).
+class LinearPhaseKernelBank {
+ public:
+  static constexpr double minFrequency = 50.0;
+  static constexpr double maxFrequency = 500.0;
+  static constexpr int stepsPerOctave = 24;
+  static constexpr int numPartitions = 16;
+
+  // the FIR length, the same for every slope
+  static int getLength(double sampleRate) {
+    return juce::nextPowerOfTwo(juce::roundToInt(sampleRate / 12.0));
+  }
+
+  LinearPhaseKernelBank(double sampleRate, int dbPerOctave)
+      : slope(dbPerOctave), length(getLength(sampleRate)), blockSize(length / numPartitions) {
+    const int numKernels =
+        juce::roundToInt(stepsPerOctave * std::log2(maxFrequency / minFrequency)) + 1;
+    for (int i = 0; i < numKernels; ++i)
+      kernels.push_back(std::make_unique<PartitionedConvolver::Kernel>(
+          design(sampleRate, getFrequency(i)).data(), length, blockSize));
+  }
+
+  static std::shared_ptr<const LinearPhaseKernelBank> get(double sampleRate, int dbPerOctave) {
+    static std::mutex mutex;
+    static std::map<std::pair<double, int>, std::weak_ptr<const LinearPhaseKernelBank>> banks;
+
+    const std::lock_guard<std::mutex> lock(mutex);
+    auto& entry = banks[{sampleRate, dbPerOctave}];
+    auto bank = entry.lock();
+    if (bank == nullptr) {
+      bank = std::make_shared<const LinearPhaseKernelBank>(sampleRate, dbPerOctave);
+      entry = bank;
+    }
+    return bank;
+  }
+
+  const PartitionedConvolver::Kernel* getKernel(double frequency) const {
+    const auto index = juce::roundToInt(stepsPerOctave * std::log2(frequency / minFrequency));
+    return kernels[static_cast<size_t>(juce::jlimit(0, static_cast<int>(kernels.size()) - 1,
+                                                    index))]
+        .get();
+  }
+
+  int getBlockSize() const { return blockSize; }
+  // the FIR is symmetric around this tap
+  int getCentre() const { return length / 2 - 1; }
+
+ private:
+  static double getFrequency(int index) {
+    return minFrequency * std::pow(2.0, static_cast<double>(index) / stepsPerOctave);
+  }
+
+  // Frequency sampling: the zero-phase response on length bins, shifted to the centre tap and
+  // windowed to length - 1 taps, so the delay is a whole number of samples. The magnitude is the
+  // Linkwitz-Riley low pass of the slope, 1 / (1 + (f / fc)^(slope / 6)).
+  std::vector<float> design(double sampleRate, double cutoff) const {
+    juce::dsp::FFT fft(juce::roundToInt(std::log2(length)));
+    std::vector<float> spectrum(static_cast<size_t>(2 * length), 0.0f);
+    for (int bin = 0; bin <= length / 2; ++bin) {
+      const auto ratio = bin * sampleRate / length / cutoff;
+      spectrum[static_cast<size_t>(2 * bin)] =
+          static_cast<float>(1.0 / (1.0 + std::pow(ratio, slope / 6.0)));
+    }
+    fft.performRealOnlyInverseTransform(spectrum.data());
+
+    const int centre = getCentre();
+    std::vector<float> impulse(static_cast<size_t>(length), 0.0f);
+    double sum = 0.0;
+    for (int n = 0; n < length - 1; ++n) {
+      const int offset = n - centre;
+      const auto window =
+          0.5 + 0.5 * std::cos(juce::MathConstants<double>::pi * offset / (centre + 1));
+      const auto tap = spectrum[static_cast<size_t>((offset + length) % length)] * window;
+      impulse[static_cast<size_t>(n)] = static_cast<float>(tap);
+      sum += tap;
+    }
+
+    // exactly unity at DC, so a mono-ised low end keeps its level
+    for (auto& tap : impulse) tap = static_cast<float>(tap / sum);
+    return impulse;
+  }
+
+  int slope;
+  int length;
+  int blockSize;
+  std::vector<std::unique_ptr<PartitionedConvolver::Kernel>> kernels;
+};
+
+// Linear-phase counterpart of LinkwitzRileyCrossover for the Bass Mono stage. The low band is a
+// symmetric FIR with the magnitude of the Linkwitz-Riley low pass; the high band is the delayed
+// input minus the low band, so the two always sum back to the delayed input.
+//
+// Instead of filtering L and R, a pair is filtered as mid and side, and only the parts the current
+// mode needs are convolved: Bass Mono alone only needs the low side, listening to the low band
+// only needs the mid as well. Everything else on the bus goes through delay() to stay aligned.
+//
+// The convolution is float only, as juce::dsp::FFT is: with SampleType double, the delay lines
+// and the high band are double, the low band has float precision (rounding around -140 dB).
+template <typename SampleType>
+class LinearPhaseCrossover {
+ public:
+  // No kernels yet: loadSlope() builds them, and until then the low band is silent.
+  void prepare(const juce::dsp::ProcessSpec& spec) {
+    {
+      const std::lock_guard<std::mutex> lock(bankMutex);
+      if (spec.sampleRate != sampleRate) {
+        for (auto& bank : loadedBanks) bank.store(nullptr, std::memory_order_relaxed);
+        ownedBanks = {};
+        sampleRate = spec.sampleRate;
+      }
+    }
+    const int length = LinearPhaseKernelBank::getLength(spec.sampleRate);
+    blockSize = length / LinearPhaseKernelBank::numPartitions;
+    latency = blockSize + length / 2 - 1;  // the convolver's block, then the FIR's centre tap
+
+    // one convolver per channel: a pair uses its left channel's for the mid, its right's for the
+    // side
+    const auto numChannels = static_cast<size_t>(spec.numChannels);
+    convolvers.resize(numChannels);
+    for (auto& convolver : convolvers)
+      convolver.prepare(blockSize, LinearPhaseKernelBank::numPartitions);
+
+    delayLines.assign(numChannels, std::vector<SampleType>(static_cast<size_t>(latency)));
+    delayPositions.assign(numChannels, 0);
+    kernelSlope = 0;
+    updateKernel();
+  }
+
+  // Builds the kernels of a slope, or shares them with another instance, for the next
+  // setSlope(). Not on the audio thread: on the message thread, or where prepare() runs, which
+  // it may run alongside. Does nothing before the first prepare(), which has the sample rate.
+  void loadSlope(int dbPerOctave) {
+    const std::lock_guard<std::mutex> lock(bankMutex);
+    const auto index = getBankIndex(dbPerOctave);
+    if (sampleRate <= 0 || ownedBanks[index] != nullptr) return;
+    ownedBanks[index] = LinearPhaseKernelBank::get(sampleRate, dbPerOctave);
+    loadedBanks[index].store(ownedBanks[index].get(), std::memory_order_release);
+  }
+
+  bool isSlopeLoaded(int dbPerOctave) const {
+    return loadedBanks[getBankIndex(dbPerOctave)].load(std::memory_order_acquire) != nullptr;
+  }
+
+  void reset() {
+    for (auto& convolver : convolvers) convolver.reset();
+    for (auto& delayLine : delayLines) std::fill(delayLine.begin(), delayLine.end(), SampleType());
+    std::fill(delayPositions.begin(), delayPositions.end(), 0);
+  }
+
+  int getLatencySamples() const { return latency; }
+
+  // Samples after the last non-silent input until the delay lines and the convolvers (two input
+  // blocks, the spectrum history, the output block) hold nothing but silence.
+  int getTailSamples() const {
+    return latency + (LinearPhaseKernelBank::numPartitions + 2) * blockSize;
+  }
+
+  // snaps to the nearest kernel; changes are crossfaded over one convolution block
+  void setCutoffFrequency(SampleType frequency) {
+    if (frequency == cutoffFrequency) return;
+    cutoffFrequency = frequency;
+    updateKernel();
+  }
+
+  // 12, 24 or 48 dB/oct, crossfaded like a cutoff change once loadSlope() has built its kernels
+  void setSlope(int dbPerOctave) {
+    jassert(dbPerOctave == 12 || dbPerOctave == 24 || dbPerOctave == 48);
+    if (dbPerOctave == slope && kernelSlope == slope) return;
+    slope = dbPerOctave;
+    updateKernel();
+  }
+
+  // Which parts of the low band processSample() has to produce for the pairs; the others stay 0.
+  // A part's convolvers are not fed while it is not needed, so one needed again starts over from
+  // silence instead of playing out what it held from before. The delay lines run all along.
+  void setBands(const ChannelGroups& groups, bool isMidNeeded, bool isSideNeeded) {
+    for (int p = 0; p < groups.numPairs; ++p) {
+      if (isMidNeeded && !needsMid) convolvers[static_cast<size_t>(groups.pairs[p].left)].reset();
+      if (isSideNeeded && !needsSide)
+        convolvers[static_cast<size_t>(groups.pairs[p].right)].reset();
+    }
+    needsMid = isMidNeeded;
+    needsSide = isSideNeeded;
+  }
+
+  // same outputs as LinkwitzRileyFilter::processSample() for both channels of a pair, delayed by
+  // getLatencySamples()
+  void processSample(ChannelGroups::Pair channels, SampleType left, SampleType right,
+                     SampleType& lowL, SampleType& highL, SampleType& lowR, SampleType& highR) {
+    constexpr SampleType half = static_cast<SampleType>(0.5);
+    SampleType lowMid = 0, lowSide = 0;
+    if (needsMid)
+      lowMid = convolvers[static_cast<size_t>(channels.left)].processSample(
+          static_cast<float>((left + right) * half));
+    if (needsSide)
+      lowSide = convolvers[static_cast<size_t>(channels.right)].processSample(
+          static_cast<float>((left - right) * half));
+
+    lowL = lowMid + lowSide;
+    lowR = lowMid - lowSide;
+    highL = delaySample(channels.left, left) - lowL;
+    highR = delaySample(channels.right, right) - lowR;
+  }
+
+  // for the channels which do not go through the crossover
+  void delay(int channel, SampleType* data, int numSamples) {
+    for (int i = 0; i < numSamples; ++i) data[i] = delaySample(channel, data[i]);
+  }
+
+ private:
+  static size_t getBankIndex(int dbPerOctave) {
+    return dbPerOctave == 12 ? 0 : (dbPerOctave == 24 ? 1 : 2);
+  }
+
+  // the selected slope's kernel, or the last slope's until the selected one is loaded
+  void updateKernel() {
+    const auto* bank = loadedBanks[getBankIndex(slope)].load(std::memory_order_acquire);
+    if (bank != nullptr)
+      kernelSlope = slope;
+    else if (kernelSlope != 0)
+      bank = loadedBanks[getBankIndex(kernelSlope)].load(std::memory_order_acquire);
+    if (bank == nullptr) return;
+
+    const auto* kernel = bank->getKernel(static_cast<double>(cutoffFrequency));
+    for (auto& convolver : convolvers) convolver.setKernel(kernel);
+  }
+
+  SampleType delaySample(int channel, SampleType sample) {
+    auto& delayLine = delayLines[static_cast<size_t>(channel)];
+    auto& position = delayPositions[static_cast<size_t>(channel)];
+    const auto delayed = delayLine[static_cast<size_t>(position)];
+    delayLine[static_cast<size_t>(position)] = sample;
+    if (++position == latency) position = 0;
+    return delayed;
+  }
+
+  // 12, 24, 48 dB/oct: owned under bankMutex by prepare() and loadSlope(), published to the
+  // audio thread, which never takes the mutex
+  std::mutex bankMutex;
+  std::array<std::shared_ptr<const LinearPhaseKernelBank>, 3> ownedBanks;
+  std::array<std::atomic<const LinearPhaseKernelBank*>, 3> loadedBanks{};
+  double sampleRate = 0;  // of the banks, 0 before prepare()
+  int blockSize = 0;
+  int latency = 0;
+  SampleType cutoffFrequency = 120;
+  int slope = 24;
+  int kernelSlope = 0;  // of the kernel in use, 0 before any is loaded
+  bool needsMid = false;
+  bool needsSide = true;
+
+  std::vector<PartitionedConvolver> convolvers;
+  std::vector<std::vector<SampleType>> delayLines;
+  std::vector<int> delayPositions;
+};
@@ -0,0 +1,245 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <vector>
+
+#include "ChannelGroups.h"
+#include "SimdOps.h"
+#include "SmoothedParameter.h"
+
+// Linkwitz-Riley low / high split of 12, 24 or 48 dB/oct: the low band is a Butterworth low pass
+// of half the order applied twice, built from topology-preserving one pole and state variable
+// sections (at 24 dB/oct the same filters and outputs as juce::dsp::LinkwitzRileyFilter). The high
+// band is the Butterworth allpass of the input minus the low band, so the two always sum to that
+// allpass; processAllpass() gives the same phase to channels which are not split.
+//
+// The cutoff glides to a new value on a multiplicative ramp, and while it does the coefficients
+// are recomputed once every controlInterval samples with a rational tan() approximation. Once it
+// has settled they are exact and cached until it changes again.
+//
+// A pair's left and right filters run side by side in one StereoOps register, every section of
+// the cascade in the same pass over the samples.
+template <typename SampleType>
+class LinkwitzRileyCrossover {
+ public:
+  static constexpr int controlInterval = 32;
+
+  void prepare(const juce::dsp::ProcessSpec& spec) {
+    sampleRate = spec.sampleRate;
+    cutoff.prepare(sampleRate, 0.02);
+    snapToCutoffFrequency(cutoff.getTargetValue());
+
+    const auto maxSegments = static_cast<size_t>(
+        (static_cast<int>(spec.maximumBlockSize) + controlInterval - 1) / controlInterval);
+    segments.assign(juce::jmax<size_t>(1, maxSegments), settled);
+    state.assign(static_cast<size_t>(spec.numChannels), State{});
+  }
+
+  void reset() { std::fill(state.begin(), state.end(), State{}); }
+
+  // 12, 24 or 48 dB/oct; a change drops the filter state
+  void setSlope(int dbPerOctave) {
+    jassert(dbPerOctave == 12 || dbPerOctave == 24 || dbPerOctave == 48);
+    if (dbPerOctave == slope) return;
+    slope = dbPerOctave;
+    reset();
+  }
+
+  // ramps from the current cutoff; setting the same value again costs nothing
+  void setCutoffFrequency(SampleType frequency) { cutoff.setTargetValue(frequency); }
+
+  // jumps without a ramp, e.g. right after prepare()
+  void snapToCutoffFrequency(SampleType frequency) {
+    cutoff.setCurrentAndTargetValue(frequency);
+    settled = makeCoefficients(std::tan(getNormalisedAngle(frequency)));
+  }
+
+  // Once per chunk of at most maximumBlockSize samples, before processSample() for any channel,
+  // so every channel of the chunk sees the same coefficients.
+  void prepareChunk(int numSamples) {
+    const int numSegments = (numSamples + controlInterval - 1) / controlInterval;
+    for (int k = 0; k < numSegments; ++k) {
+      if (cutoff.isSmoothing()) {
+        const int length = juce::jmin(controlInterval, numSamples - k * controlInterval);
+        const auto angle = getNormalisedAngle(cutoff.skip(length));
+        settled = makeCoefficients(cutoff.isSmoothing() ? fastTan(angle) : std::tan(angle));
+      }
+      segments[static_cast<size_t>(k)] = settled;
+    }
+  }
+
+  // in place of prepareChunk() for samples which are not processed: the cutoff ramp moves on
+  void skip(int numSamples) {
+    if (!cutoff.isSmoothing()) return;
+    const auto angle = getNormalisedAngle(cutoff.skip(numSamples));
+    settled = makeCoefficients(cutoff.isSmoothing() ? fastTan(angle) : std::tan(angle));
+  }
+
+  // every channel's state within threshold of 0, so silence in gives silence out
+  bool isDecayed(SampleType threshold) const {
+    for (const auto& channel : state)
+      for (const auto& value : channel.values)
+        if (std::abs(Ops::getLeft(value)) > threshold || std::abs(Ops::getRight(value)) > threshold)
+          return false;
+    return true;
+  }
+
+  int getSlope() const { return slope; }
+
+  // Index is the sample's position in the chunk. The slope is a template argument, so a caller
+  // which picks it once per block gets a loop without the switch; it must be getSlope().
+  template <int dbPerOctave>
+  void processSample(ChannelGroups::Pair channels, int index, SampleType left, SampleType right,
+                     SampleType& lowL, SampleType& highL, SampleType& lowR, SampleType& highR) {
+    static_assert(dbPerOctave == 12 || dbPerOctave == 24 || dbPerOctave == 48);
+    jassert(dbPerOctave == slope);
+    const auto& c = segments[static_cast<size_t>(index / controlInterval)];
+    auto* s = state[static_cast<size_t>(channels.left)].values;  // the pair's state
+    const auto input = Ops::make(left, right);
+
+    Vector low, allpass;
+    if constexpr (dbPerOctave == 12) {
+      const auto lp = onePole(input, c.onePole, s[0]);
+      low = onePole(lp, c.onePole, s[1]);
+      allpass = Ops::sub(Ops::add(lp, lp), input);
+    } else if constexpr (dbPerOctave == 24) {
+      Vector band, high;
+      const auto lp = section(input, c.g, c.butterworth2, s[0], s[1], band, high);
+      allpass = getAllpass(lp, band, high, c.butterworth2);
+      low = section(lp, c.g, c.butterworth2, s[2], s[3], band, high);
+    } else {
+      Vector band, high;
+      const auto lpA = section(input, c.g, c.butterworth4[0], s[0], s[1], band, high);
+      const auto allpassA = getAllpass(lpA, band, high, c.butterworth4[0]);
+      const auto lpB = section(lpA, c.g, c.butterworth4[1], s[2], s[3], band, high);
+      const auto lpC = section(lpB, c.g, c.butterworth4[0], s[4], s[5], band, high);
+      low = section(lpC, c.g, c.butterworth4[1], s[6], s[7], band, high);
+
+      const auto lpD = section(allpassA, c.g, c.butterworth4[1], s[8], s[9], band, high);
+      allpass = getAllpass(lpD, band, high, c.butterworth4[1]);
+    }
+
+    const auto high = Ops::sub(allpass, low);
+    lowL = Ops::getLeft(low);
+    lowR = Ops::getRight(low);
+    highL = Ops::getLeft(high);
+    highR = Ops::getRight(high);
+  }
+
+  // Only the allpass, in place, for a channel outside the pairs over a whole chunk. It uses the
+  // channel's own state, so it cannot be the left channel of a pair.
+  void processAllpass(int channel, SampleType* data, int numSamples) {
+    switch (slope) {
+      case 12:
+        return processAllpass<12>(channel, data, numSamples);
+      case 24:
+        return processAllpass<24>(channel, data, numSamples);
+      default:
+        return processAllpass<48>(channel, data, numSamples);
+    }
+  }
+
+ private:
+  using Ops = StereoOps<SampleType>;
+  using Vector = typename Ops::Vector;
+
+  // a second order section with damping k = 1 / Q, broadcast to both lanes
+  struct SectionCoefficients {
+    Vector k, h, kPlusG;
+  };
+
+  struct Coefficients {
+    Vector g;
+    Vector onePole;                                  // g / (1 + g), 12 dB/oct
+    SectionCoefficients butterworth2;                // 24 dB/oct
+    std::array<SectionCoefficients, 2> butterworth4;  // 48 dB/oct
+  };
+
+  // two per section, enough for the 48 dB/oct low pass and allpass cascades
+  struct State {
+    Vector values[10];
+  };
+
+  template <int dbPerOctave>
+  void processAllpass(int channel, SampleType* data, int numSamples) {
+    auto* s = state[static_cast<size_t>(channel)].values;
+    for (int i = 0; i < numSamples; ++i) {
+      const auto& c = segments[static_cast<size_t>(i / controlInterval)];
+      const auto input = Ops::make(data[i], 0);
+
+      Vector allpass, band, high;
+      if constexpr (dbPerOctave == 12) {
+        const auto lp = onePole(input, c.onePole, s[0]);
+        allpass = Ops::sub(Ops::add(lp, lp), input);
+      } else if constexpr (dbPerOctave == 24) {
+        const auto lp = section(input, c.g, c.butterworth2, s[0], s[1], band, high);
+        allpass = getAllpass(lp, band, high, c.butterworth2);
+      } else {
+        const auto lpA = section(input, c.g, c.butterworth4[0], s[0], s[1], band, high);
+        const auto allpassA = getAllpass(lpA, band, high, c.butterworth4[0]);
+        const auto lpB = section(allpassA, c.g, c.butterworth4[1], s[2], s[3], band, high);
+        allpass = getAllpass(lpB, band, high, c.butterworth4[1]);
+      }
+      data[i] = Ops::getLeft(allpass);
+    }
+  }
+
+  static Vector onePole(Vector input, Vector gain, Vector& s) {
+    const auto v = Ops::mul(Ops::sub(input, s), gain);
+    const auto lp = Ops::add(v, s);
+    s = Ops::add(lp, v);
+    return lp;
+  }
+
+  // topology-preserving state variable filter, returns the low pass
+  static Vector section(Vector input, Vector g, const SectionCoefficients& c, Vector& s1,
+                        Vector& s2, Vector& band, Vector& high) {
+    high = Ops::mul(Ops::sub(Ops::sub(input, Ops::mul(c.kPlusG, s1)), s2), c.h);
+    band = Ops::add(Ops::mul(g, high), s1);
+    s1 = Ops::add(Ops::mul(g, high), band);
+    const auto low = Ops::add(Ops::mul(g, band), s2);
+    s2 = Ops::add(Ops::mul(g, band), low);
+    return low;
+  }
+
+  static Vector getAllpass(Vector low, Vector band, Vector high, const SectionCoefficients& c) {
+    return Ops::add(Ops::sub(low, Ops::mul(c.k, band)), high);
+  }
+
+  static constexpr SampleType r2 = juce::MathConstants<SampleType>::sqrt2;
+
+  SampleType getNormalisedAngle(SampleType frequency) const {
+    return juce::MathConstants<SampleType>::pi * frequency / static_cast<SampleType>(sampleRate);
+  }
+
+  // [3/2] Pade approximant: relative error below 1e-5 for cutoffs up to about sampleRate / 6
+  static SampleType fastTan(SampleType x) {
+    const auto x2 = x * x;
+    return x * (15 - x2) / (15 - 6 * x2);
+  }
+
+  static SectionCoefficients makeSection(SampleType k, SampleType g) {
+    return {Ops::broadcast(k), Ops::broadcast(1 / (1 + k * g + g * g)), Ops::broadcast(k + g)};
+  }
+
+  static Coefficients makeCoefficients(SampleType g) {
+    // damping of the two sections of a 4th order Butterworth filter, 2 cos(pi / 8) and
+    // 2 cos(3 pi / 8)
+    constexpr auto k1 = static_cast<SampleType>(1.8477590650225735);
+    constexpr auto k2 = static_cast<SampleType>(0.7653668647301796);
+    return {Ops::broadcast(g),
+            Ops::broadcast(g / (1 + g)),
+            makeSection(r2, g),
+            {makeSection(k1, g), makeSection(k2, g)}};
+  }
+
+  double sampleRate = 44100.0;
+  int slope = 24;
+  SmoothedParameter<SampleType> cutoff{static_cast<SampleType>(120),
+                                       SmoothedParameter<SampleType>::Curve::MULTIPLICATIVE};
+
+  Coefficients settled;
+  std::vector<Coefficients> segments;  // per controlInterval samples of the current chunk
+  std::vector<State> state;  // per channel, a pair uses its left channel's
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cmath>
+
+// Time spent in processBlock relative to the real-time budget of the block (numSamples at the
+// sample rate), timed like juce::AudioProcessLoadMeasurer with one pair of high resolution ticks
+// per block. Every block is counted in a histogram of log spaced buckets, 8 per octave (about 9%
+// wide) from 1/16384 of the budget to 4 times it; the first and last bucket also take whatever
+// falls outside.
+//
+// The audio thread is the only writer and never resets a count. A reader takes a snapshot with
+// getHistogram(); the difference of two snapshots is the histogram of the blocks in between, so
+// the editor can show the load of the last few seconds without touching the audio thread.
+class LoadMeter {
+ public:
+  static constexpr int bucketsPerOctave = 8;
+  static constexpr int numBuckets = 16 * bucketsPerOctave;
+  static constexpr double minLoad = 1.0 / 16384;
+
+  using Histogram = std::array<juce::uint32, numBuckets>;
+
+  void prepare(double sampleRate) {
+    ticksPerSample =
+        static_cast<double>(juce::Time::getHighResolutionTicksPerSecond()) / sampleRate;
+  }
+
+  // around processBlock: no allocation, one timestamp on entry and one on exit
+  class ScopedTimer {
+   public:
+    ScopedTimer(LoadMeter& meterToUse, int numSamplesInBlock)
+        : meter(meterToUse),
+          numSamples(numSamplesInBlock),
+          start(juce::Time::getHighResolutionTicks()) {}
+    ~ScopedTimer() { meter.add(juce::Time::getHighResolutionTicks() - start, numSamples); }
+
+   private:
+    LoadMeter& meter;
+    const int numSamples;
+    const juce::int64 start;
+
+    JUCE_DECLARE_NON_COPYABLE(ScopedTimer)
+  };
+
+  //==============================================================================
+  // any thread
+  Histogram getHistogram() const {
+    Histogram histogram;
+    for (size_t i = 0; i < histogram.size(); ++i)
+      histogram[i] = counts[i].load(std::memory_order_relaxed);
+    return histogram;
+  }
+
+  // the blocks counted after older was taken; the counts wrap, the difference does not
+  static Histogram getDifference(const Histogram& newer, const Histogram& older) {
+    Histogram difference;
+    for (size_t i = 0; i < difference.size(); ++i) difference[i] = newer[i] - older[i];
+    return difference;
+  }
+
+  static juce::uint64 getNumBlocks(const Histogram& histogram) {
+    juce::uint64 numBlocks = 0;
+    for (const auto count : histogram) numBlocks += count;
+    return numBlocks;
+  }
+
+  // The load which a fraction (0.5 for the median) of the blocks stay within, read as the upper
+  // edge of its bucket so it never reads low; 0 for an empty histogram.
+  static double getPercentile(const Histogram& histogram, double fraction) {
+    const auto numBlocks = getNumBlocks(histogram);
+    if (numBlocks == 0) return 0;
+
+    const auto rank = static_cast<juce::uint64>(std::ceil(fraction * numBlocks));
+    juce::uint64 cumulative = 0;
+    for (int bucket = 0; bucket < numBuckets; ++bucket) {
+      cumulative += histogram[static_cast<size_t>(bucket)];
+      if (cumulative > 0 && cumulative >= rank) return getUpperEdge(bucket);
+    }
+    return getUpperEdge(numBuckets - 1);
+  }
+
+ private:
+  static double getUpperEdge(int bucket) {
+    return minLoad * std::exp2(static_cast<double>(bucket + 1) / bucketsPerOctave);
+  }
+
+  // audio thread
+  void add(juce::int64 ticks, int numSamples) {
+    if (numSamples <= 0 || ticksPerSample <= 0) return;
+
+    const auto load = static_cast<double>(ticks) / (numSamples * ticksPerSample);
+    const auto octaves = load > minLoad ? std::log2(load / minLoad) : 0.0;
+    const int bucket = juce::jmin(numBuckets - 1, static_cast<int>(octaves * bucketsPerOctave));
+    // a single writer: a plain load and store, no locked read-modify-write
+    auto& count = counts[static_cast<size_t>(bucket)];
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+
+  double ticksPerSample = 0;  // set in prepareToPlay, before any block
+  std::array<std::atomic<juce::uint32>, numBuckets> counts{};
+};
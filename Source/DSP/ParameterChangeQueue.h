@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+
+// Parameter changes at a sample offset into the next processBlock. JUCE's plugin wrappers apply
+// the last value of each parameter before calling processBlock, so host automation is only block
+// accurate; a caller which knows where in the block a value changes (the renderer, a host
+// wrapper with a timestamped queue) pushes the changes here first, and processBlock splits the
+// block at their offsets.
+//
+// The parameters themselves are not touched: from its offset on, a change overrides the
+// parameter's value in the snapshot of each segment (getValue()), and endBlock() drops the
+// overrides. So the parameters hold the values of the start of the block, and the caller sets
+// them to the last values after processBlock, as a host does, not the audio thread.
+//
+// Not thread safe: push from the thread which calls processBlock, right before calling it. At
+// most maxSplits splits per block, so dense automation costs a bounded number of extra segments;
+// past the budget the remaining changes of the block land together at the offset of the first.
+class ParameterChangeQueue {
+ public:
+  static constexpr int capacity = 256;
+  static constexpr int maxSplits = 16;
+  static constexpr int maxParameters = 64;  // by getParameterIndex()
+
+  // kept in offset order, pushes at the same offset in push order; false when full
+  bool push(juce::AudioProcessorParameter& parameter, float normalisedValue, int sampleOffset) {
+    const int parameterIndex = parameter.getParameterIndex();
+    if (size == capacity || parameterIndex < 0 || parameterIndex >= maxParameters) return false;
+
+    int index = size++;
+    for (; index > 0 && changes[static_cast<size_t>(index - 1)].offset > sampleOffset; --index)
+      changes[static_cast<size_t>(index)] = changes[static_cast<size_t>(index - 1)];
+    changes[static_cast<size_t>(index)] = {parameterIndex, normalisedValue, sampleOffset};
+    return true;
+  }
+
+  bool isEmpty() const { return size == 0; }
+
+  // Applies the changes due at start and returns the end of the segment starting there: the
+  // offset of the next change, or numSamples.
+  int beginSegment(int start, int numSamples) {
+    const bool isLastSplit = numSegments++ == maxSplits;
+    while (next < size && (isLastSplit || changes[static_cast<size_t>(next)].offset <= start))
+      apply(changes[static_cast<size_t>(next++)]);
+    return next < size ? juce::jmin(changes[static_cast<size_t>(next)].offset, numSamples)
+                       : numSamples;
+  }
+
+  // every change of the block at once, for a block processed as one segment
+  void applyAll() {
+    while (next < size) apply(changes[static_cast<size_t>(next++)]);
+  }
+
+  // the normalised value queued for the segment, if the parameter has one
+  bool getValue(int parameterIndex, float& normalisedValue) const {
+    if (parameterIndex < 0 || parameterIndex >= maxParameters ||
+        !isOverridden[static_cast<size_t>(parameterIndex)])
+      return false;
+    normalisedValue = overrides[static_cast<size_t>(parameterIndex)];
+    return true;
+  }
+
+  // after the last segment; changes at or past the end of the block are dropped
+  void endBlock() {
+    for (int i = 0; i < size; ++i)
+      isOverridden[static_cast<size_t>(changes[static_cast<size_t>(i)].parameterIndex)] = false;
+    size = next = numSegments = 0;
+  }
+
+ private:
+  struct Change {
+    int parameterIndex;
+    float value;
+    int offset;
+  };
+
+  void apply(const Change& change) {
+    overrides[static_cast<size_t>(change.parameterIndex)] = change.value;
+    isOverridden[static_cast<size_t>(change.parameterIndex)] = true;
+  }
+
+  std::array<Change, capacity> changes{};
+  int size = 0;
+  int next = 0;
+  int numSegments = 0;
+  std::array<float, maxParameters> overrides{};
+  std::array<bool, maxParameters> isOverridden{};
+};
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <complex>
+#include <memory>
+#include <vector>
+
+// Uniformly partitioned overlap-save convolution. The impulse response is cut into partitions of
+// blockSize samples, each transformed once with a 2 * blockSize FFT (PartitionedConvolver::Kernel,
+// built off the audio thread and shareable). Every blockSize input samples, the newest input
+// spectrum enters a frequency-domain delay line and the output block is the sum of the delay
+// line times the kernel partitions. processSample() therefore has a fixed latency of blockSize.
+class PartitionedConvolver {
+ public:
+  using Complex = std::complex<float>;
+
+  // the spectra of every partition, numPartitions * (blockSize + 1) bins
+  class Kernel {
+   public:
+    Kernel(const float* impulse, int length, int blockSizeToUse)
+        : blockSize(blockSizeToUse),
+          numPartitions((length + blockSizeToUse - 1) / blockSizeToUse),
+          spectra(static_cast<size_t>(numPartitions * (blockSizeToUse + 1))) {
+      juce::dsp::FFT fft(juce::roundToInt(std::log2(2 * blockSize)));
+      std::vector<float> buffer(static_cast<size_t>(4 * blockSize));
+
+      for (int p = 0; p < numPartitions; ++p) {
+        std::fill(buffer.begin(), buffer.end(), 0.0f);
+        const int num = juce::jmin(blockSize, length - p * blockSize);
+        std::copy(impulse + p * blockSize, impulse + p * blockSize + num, buffer.begin());
+
+        fft.performRealOnlyForwardTransform(buffer.data(), true);
+        std::copy_n(reinterpret_cast<const Complex*>(buffer.data()), blockSize + 1,
+                    spectra.data() + p * (blockSize + 1));
+      }
+    }
+
+    int getBlockSize() const { return blockSize; }
+    int getNumPartitions() const { return numPartitions; }
+    const Complex* getPartition(int index) const {
+      return spectra.data() + index * (blockSize + 1);
+    }
+
+   private:
+    int blockSize;
+    int numPartitions;
+    std::vector<Complex> spectra;
+  };
+
+  void prepare(int blockSizeToUse, int numPartitionsToUse) {
+    blockSize = blockSizeToUse;
+    numPartitions = numPartitionsToUse;
+    fft = std::make_unique<juce::dsp::FFT>(juce::roundToInt(std::log2(2 * blockSize)));
+
+    const auto numBins = static_cast<size_t>(blockSize + 1);
+    input.assign(static_cast<size_t>(2 * blockSize), 0.0f);
+    output.assign(static_cast<size_t>(blockSize), 0.0f);
+    fftBuffer.assign(static_cast<size_t>(4 * blockSize), 0.0f);
+    fadeBuffer.assign(static_cast<size_t>(4 * blockSize), 0.0f);
+    delayLine.assign(static_cast<size_t>(numPartitions) * numBins, Complex());
+    kernel = pendingKernel = nullptr;  // made for the previous sizes, if any
+    reset();
+  }
+
+  void reset() {
+    std::fill(input.begin(), input.end(), 0.0f);
+    std::fill(output.begin(), output.end(), 0.0f);
+    std::fill(delayLine.begin(), delayLine.end(), Complex());
+    position = 0;
+    newestPartition = 0;
+  }
+
+  // Takes effect at the next block boundary; the first block after a change crossfades from the
+  // previous kernel's output to the new one. The kernel must outlive its use here.
+  void setKernel(const Kernel* newKernel) {
+    jassert(newKernel == nullptr || (newKernel->getBlockSize() == blockSize &&
+                                     newKernel->getNumPartitions() == numPartitions));
+    pendingKernel = newKernel;
+  }
+
+  int getLatencySamples() const { return blockSize; }
+
+  float processSample(float sample) {
+    input[static_cast<size_t>(blockSize + position)] = sample;
+    const float result = output[static_cast<size_t>(position)];
+    if (++position == blockSize) processBlock();
+    return result;
+  }
+
+ private:
+  void processBlock() {
+    position = 0;
+
+    // newest input spectrum of the last 2 * blockSize samples
+    newestPartition = (newestPartition + numPartitions - 1) % numPartitions;
+    std::copy(input.begin(), input.end(), fftBuffer.begin());
+    std::fill(fftBuffer.begin() + 2 * blockSize, fftBuffer.end(), 0.0f);
+    fft->performRealOnlyForwardTransform(fftBuffer.data(), true);
+    std::copy_n(reinterpret_cast<const Complex*>(fftBuffer.data()), blockSize + 1,
+                delayLine.data() + newestPartition * (blockSize + 1));
+    std::copy(input.begin() + blockSize, input.end(), input.begin());
+
+    if (pendingKernel != kernel && kernel != nullptr && pendingKernel != nullptr) {
+      convolve(*kernel, fadeBuffer.data());
+      convolve(*pendingKernel, fftBuffer.data());
+      const float step = 1.0f / static_cast<float>(blockSize);
+      for (int i = 0; i < blockSize; ++i) {
+        const float fade = static_cast<float>(i) * step;
+        output[static_cast<size_t>(i)] = fadeBuffer[static_cast<size_t>(blockSize + i)] +
+                                         fade * (fftBuffer[static_cast<size_t>(blockSize + i)] -
+                                                 fadeBuffer[static_cast<size_t>(blockSize + i)]);
+      }
+      kernel = pendingKernel;
+      return;
+    }
+
+    kernel = pendingKernel;
+    if (kernel == nullptr) {
+      std::fill(output.begin(), output.end(), 0.0f);
+      return;
+    }
+
+    convolve(*kernel, fftBuffer.data());
+    std::copy_n(fftBuffer.begin() + blockSize, blockSize, output.begin());
+  }
+
+  // sum of every input spectrum times its partition, back to the time domain in result
+  void convolve(const Kernel& impulse, float* result) const {
+    const int numBins = blockSize + 1;
+    std::fill(result, result + 4 * blockSize, 0.0f);
+
+    // written out on the interleaved floats: std::complex's operator* checks for infinities
+    for (int p = 0; p < numPartitions; ++p) {
+      const auto* x = reinterpret_cast<const float*>(
+          delayLine.data() + ((newestPartition + p) % numPartitions) * numBins);
+      const auto* h = reinterpret_cast<const float*>(impulse.getPartition(p));
+      for (int bin = 0; bin < 2 * numBins; bin += 2) {
+        result[bin] += x[bin] * h[bin] - x[bin + 1] * h[bin + 1];
+        result[bin + 1] += x[bin] * h[bin + 1] + x[bin + 1] * h[bin];
+      }
+    }
+
+    // the first blockSize samples are the wrapped-around part of the circular convolution
+    fft->performRealOnlyInverseTransform(result);
+  }
+
+  int blockSize = 0;
+  int numPartitions = 0;
+  std::unique_ptr<juce::dsp::FFT> fft;
+
+  const Kernel* kernel = nullptr;
+  const Kernel* pendingKernel = nullptr;
+
+  std::vector<float> input;   // previous and current input block
+  std::vector<float> output;  // the block being played out
+  std::vector<float> fftBuffer, fadeBuffer;
+  std::vector<Complex> delayLine;  // input spectra, newest at newestPartition
+  int position = 0;
+  int newestPartition = 0;
+};
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+#include "ChannelGroups.h"
+
+// same order as channelModeList / stereoModeList in UI/Constant.h
+enum class ChannelMode { LEFT, STEREO, RIGHT, SWAP };
+enum class StereoMode { WIDTH, MID_SIDE };
+
+// typed copy of every parameter, taken once at the top of processBlock
+struct ParameterSnapshot {
+  float gain = 0.0f;  // dB
+  bool isInvertPhaseL = false;
+  bool isInvertPhaseR = false;
+  ChannelMode channelMode = ChannelMode::STEREO;
+  bool isMono = false;
+  float pan = 0.0f;  // -50 to 50
+  StereoMode stereoMode = StereoMode::WIDTH;
+  float stereoWidth = 100.0f;   // 0 to 400
+  float stereoMidSide = 0.0f;   // -100 to 100
+  bool isBassMono = false;
+  float bassMonoFrequency = 120.0f;
+  bool isBassMonoListening = false;
+  bool isBassMonoLinearPhase = false;
+  int bassMonoSlope = 24;  // dB/oct: 12, 24 or 48
+  bool isDc = false;
+
+  bool isMonoByChannelMode() const {
+    return channelMode == ChannelMode::LEFT || channelMode == ChannelMode::RIGHT;
+  }
+};
+
+// ordered list of the stages which actually do something for the current snapshot
+class ProcessingPlan {
+ public:
+  enum class Stage : uint8_t {
+    PHASE,
+    CHANNEL_MODE,
+    WIDTH,
+    MID_SIDE,
+    MONO,
+    BASS_MONO,
+    GAIN,
+    PAN,
+    DC,
+  };
+
+  static constexpr int maxStages = 9;
+
+  // Smoothed stages still on their way to the snapshot's value (UtilityEngine::getRamps). Gain
+  // automated back to 0 dB keeps its stage until the ramp gets there, so neither the plan nor the
+  // bypass built on it drops the last part of the ramp.
+  struct Ramps {
+    bool isGain = false;
+    bool isPan = false;
+  };
+
+  // the stereo stages only run when the bus has at least one left/right pair
+  static ProcessingPlan build(const ParameterSnapshot& params, const ChannelGroups& groups,
+                              const Ramps& ramps) {
+    ProcessingPlan plan;
+    const bool isStereo = groups.numPairs > 0;
+    const bool isMonoByChannelMode = params.isMonoByChannelMode();
+
+    if (params.isInvertPhaseL || (isStereo && params.isInvertPhaseR)) plan.add(Stage::PHASE);
+    if (isStereo && params.channelMode != ChannelMode::STEREO) plan.add(Stage::CHANNEL_MODE);
+    if (isStereo && !params.isMono && !isMonoByChannelMode)
+      plan.add(params.stereoMode == StereoMode::WIDTH ? Stage::WIDTH : Stage::MID_SIDE);
+    if (isStereo && params.isMono && !isMonoByChannelMode) plan.add(Stage::MONO);
+    if (isStereo && ((params.isBassMono && !params.isMono) || params.isBassMonoListening) &&
+        !isMonoByChannelMode)
+      plan.add(Stage::BASS_MONO);
+    if (params.gain != 0.0f || ramps.isGain) plan.add(Stage::GAIN);
+    if (isStereo && (params.pan != 0.0f || ramps.isPan)) plan.add(Stage::PAN);
+    if (params.isDc) plan.add(Stage::DC);
+
+    // at most a Width / Mid/Side stage at its neutral value, and no linear-phase latency
+    const bool isStereoNeutral = params.stereoMode == StereoMode::WIDTH
+                                     ? params.stereoWidth == 100.0f
+                                     : params.stereoMidSide == 0.0f;
+    plan.identity = !params.isBassMonoLinearPhase &&
+                    std::all_of(plan.begin(), plan.end(), [&](Stage stage) {
+                      return (stage == Stage::WIDTH || stage == Stage::MID_SIDE) && isStereoNeutral;
+                    });
+    return plan;
+  }
+
+  // the output is the input, sample for sample
+  bool isIdentity() const { return identity; }
+
+  bool has(Stage stage) const {
+    for (auto s : *this)
+      if (s == stage) return true;
+    return false;
+  }
+
+  int size() const { return numStages; }
+  const Stage* begin() const { return stages.data(); }
+  const Stage* end() const { return stages.data() + numStages; }
+
+ private:
+  void add(Stage stage) { stages[numStages++] = stage; }
+
+  std::array<Stage, maxStages> stages{};
+  int numStages = 0;
+  bool identity = false;
+};
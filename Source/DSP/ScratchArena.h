@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Working memory for the audio thread. Everything is allocated in prepare(), so processBlock
+// only hands out pointers into it. A slot holds getBlockSize() samples; callers split longer
+// host blocks into chunks of that size instead of growing the arena.
+template <typename SampleType>
+class ScratchArena {
+ public:
+  static constexpr int alignment = 32;  // bytes, enough for AVX loads
+
+  void prepare(int numSlotsToUse, int maximumBlockSize) {
+    numSlots = numSlotsToUse;
+    blockSize = maximumBlockSize > 0 ? maximumBlockSize : 1;
+
+    // keep every slot aligned by rounding its length up to a whole number of vectors
+    constexpr int samplesPerVector = alignment / static_cast<int>(sizeof(SampleType));
+    stride = (blockSize + samplesPerVector - 1) / samplesPerVector * samplesPerVector;
+
+    storage.assign(static_cast<std::size_t>(numSlots * stride + samplesPerVector), SampleType(0));
+    const auto address = reinterpret_cast<std::uintptr_t>(storage.data());
+    const auto padding = (alignment - address % alignment) % alignment;
+    base = storage.data() + padding / sizeof(SampleType);
+  }
+
+  int getBlockSize() const { return blockSize; }
+  int getNumSlots() const { return numSlots; }
+
+  SampleType* getSlot(int index) {
+    jassert(index >= 0 && index < numSlots);
+    return base + index * stride;
+  }
+
+ private:
+  std::vector<SampleType> storage;
+  SampleType* base = nullptr;
+  int numSlots = 0;
+  int blockSize = 0;
+  int stride = 0;
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include "SimdKernels.h"
+
+// The widest build of the kernels which both this CPU (as JUCE reads its feature flags) and the
+// plugin binary have. Cheap enough to call for every new instance: JUCE reads the flags once.
+inline SimdLevel detectSimdLevel() {
+  const auto isBuilt = [](SimdLevel level) {
+    return SimdKernels<float>::get(level) != nullptr && SimdKernels<double>::get(level) != nullptr;
+  };
+
+  if (juce::SystemStats::hasAVX512F() && isBuilt(SimdLevel::AVX512)) return SimdLevel::AVX512;
+  if (juce::SystemStats::hasAVX2() && isBuilt(SimdLevel::AVX2)) return SimdLevel::AVX2;
+  if (isBuilt(SimdLevel::SSE2)) return SimdLevel::SSE2;
+  return SimdLevel::SCALAR;
+}
+
+inline const char* getSimdLevelName(SimdLevel level) {
+  switch (level) {
+    case SimdLevel::SSE2:
+      return "SSE2";
+    case SimdLevel::AVX2:
+      return "AVX2";
+    case SimdLevel::AVX512:
+      return "AVX-512";
+    default:
+      return "scalar";
+  }
+}
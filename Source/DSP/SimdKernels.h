@@ -0,0 +1,195 @@
+#pragma once
+
+#include "SimdOps.h"
+#include "StereoMatrix.h"
+
+// The loops which walk whole blocks: the stereo matrix, the Width / Mid/Side ramp, the silence
+// test and the level meter. Each one is written once over Ops and built for every instruction set
+// the target has, SSE2 in the plugin's own sources and AVX2 / AVX-512 in SimdKernelsAvx2.cpp /
+// SimdKernelsAvx512.cpp, which are compiled with those instruction sets enabled. An instance
+// picks one table of them when it is created (SimdDispatch.h); the recursive filters stay on the
+// SSE2 pair in StereoOps, a wider register does not help a left/right state update.
+//
+// This header is included by the AVX2 / AVX-512 sources, so it stays free of JUCE and the
+// kernels call nothing but their Ops: any other inline function would be compiled there with
+// the wider instruction set too, and the linker may keep that copy for the whole plugin.
+// For the same reason Ops has no default: NativeOps names a different type in each of those
+// sources, so a defaulted call would be a different function depending on where it is compiled.
+
+enum class SimdLevel { SCALAR, SSE2, AVX2, AVX512 };
+
+// peaks and sums of one block, which LevelMeter turns into peak, RMS and correlation
+struct LevelSums {
+  float peakL = 0, peakR = 0;
+  float sumSquaresL = 0, sumSquaresR = 0, sumProducts = 0;
+};
+
+template <typename SampleType, typename Ops>
+void applyStereoMatrix(SampleType* left, SampleType* right, int numSamples,
+                       const StereoMatrix<SampleType>& m) {
+  const auto ll = Ops::broadcast(m.ll);
+  const auto lr = Ops::broadcast(m.lr);
+  const auto rl = Ops::broadcast(m.rl);
+  const auto rr = Ops::broadcast(m.rr);
+
+  int i = 0;
+  for (; i + Ops::size <= numSamples; i += Ops::size) {
+    const auto l = Ops::load(left + i);
+    const auto r = Ops::load(right + i);
+    Ops::store(left + i, Ops::add(Ops::mul(ll, l), Ops::mul(lr, r)));
+    Ops::store(right + i, Ops::add(Ops::mul(rl, l), Ops::mul(rr, r)));
+  }
+  for (; i < numSamples; ++i) {
+    const auto l = left[i];
+    const auto r = right[i];
+    left[i] = m.ll * l + m.lr * r;
+    right[i] = m.rl * l + m.rr * r;
+  }
+}
+
+// Width / Mid/Side with per-sample ramps. The smoothers are rendered into the four ramp buffers
+// beforehand, so this only does the arithmetic, Ops::size samples at a time:
+//   (l, r) = routing * (l, r)
+//   mid = (l + r) * midScale, side = (r - l) * sideScale
+//   l = (mid - side) / 2 * outputGainL, r = (mid + side) / 2 * outputGainR
+template <typename SampleType, typename Ops>
+void applyMidSideRamp(SampleType* left, SampleType* right, int numSamples,
+                      const StereoMatrix<SampleType>& routing, const SampleType* midScale,
+                      const SampleType* sideScale, const SampleType* outputGainL,
+                      const SampleType* outputGainR) {
+  const auto ll = Ops::broadcast(routing.ll);
+  const auto lr = Ops::broadcast(routing.lr);
+  const auto rl = Ops::broadcast(routing.rl);
+  const auto rr = Ops::broadcast(routing.rr);
+  const auto half = Ops::broadcast(SampleType(0.5));
+
+  int i = 0;
+  for (; i + Ops::size <= numSamples; i += Ops::size) {
+    const auto inL = Ops::load(left + i);
+    const auto inR = Ops::load(right + i);
+    const auto l = Ops::add(Ops::mul(ll, inL), Ops::mul(lr, inR));
+    const auto r = Ops::add(Ops::mul(rl, inL), Ops::mul(rr, inR));
+    const auto mid = Ops::mul(Ops::add(l, r), Ops::load(midScale + i));
+    const auto side = Ops::mul(Ops::sub(r, l), Ops::load(sideScale + i));
+    const auto gainL = Ops::mul(half, Ops::load(outputGainL + i));
+    const auto gainR = Ops::mul(half, Ops::load(outputGainR + i));
+    Ops::store(left + i, Ops::mul(Ops::sub(mid, side), gainL));
+    Ops::store(right + i, Ops::mul(Ops::add(mid, side), gainR));
+  }
+  for (; i < numSamples; ++i) {
+    const auto l = routing.ll * left[i] + routing.lr * right[i];
+    const auto r = routing.rl * left[i] + routing.rr * right[i];
+    const auto mid = (l + r) * midScale[i];
+    const auto side = (r - l) * sideScale[i];
+    left[i] = (mid - side) * (SampleType(0.5) * outputGainL[i]);
+    right[i] = (mid + side) * (SampleType(0.5) * outputGainR[i]);
+  }
+}
+
+// max |x| over the block
+template <typename SampleType, typename Ops>
+SampleType getMaxAbs(const SampleType* data, int numSamples) {
+  auto peak = Ops::broadcast(0);
+  int i = 0;
+  for (; i + Ops::size <= numSamples; i += Ops::size)
+    peak = Ops::max(peak, Ops::abs(Ops::load(data + i)));
+
+  auto result = reduceMax<Ops, SampleType>(peak);
+  for (; i < numSamples; ++i) {
+    const auto value = data[i] < 0 ? -data[i] : data[i];
+    result = value > result ? value : result;
+  }
+  return result;
+}
+
+// one pass over the block: lane-wise maxima and sums, reduced at the end
+template <typename SampleType, typename Ops>
+LevelSums measureLevels(const SampleType* left, const SampleType* right, int numSamples) {
+  auto peakL = Ops::broadcast(0), peakR = Ops::broadcast(0);
+  auto squaresL = Ops::broadcast(0), squaresR = Ops::broadcast(0);
+  auto products = Ops::broadcast(0);
+
+  int i = 0;
+  for (; i + Ops::size <= numSamples; i += Ops::size) {
+    const auto l = Ops::load(left + i);
+    const auto r = Ops::load(right + i);
+    peakL = Ops::max(peakL, Ops::abs(l));
+    peakR = Ops::max(peakR, Ops::abs(r));
+    squaresL = Ops::add(squaresL, Ops::mul(l, l));
+    squaresR = Ops::add(squaresR, Ops::mul(r, r));
+    products = Ops::add(products, Ops::mul(l, r));
+  }
+
+  LevelSums sums;
+  sums.peakL = static_cast<float>(reduceMax<Ops, SampleType>(peakL));
+  sums.peakR = static_cast<float>(reduceMax<Ops, SampleType>(peakR));
+  sums.sumSquaresL = static_cast<float>(reduceAdd<Ops, SampleType>(squaresL));
+  sums.sumSquaresR = static_cast<float>(reduceAdd<Ops, SampleType>(squaresR));
+  sums.sumProducts = static_cast<float>(reduceAdd<Ops, SampleType>(products));
+
+  for (; i < numSamples; ++i) {
+    const auto l = static_cast<float>(left[i]);
+    const auto r = static_cast<float>(right[i]);
+    const auto absL = l < 0 ? -l : l;
+    const auto absR = r < 0 ? -r : r;
+    sums.peakL = absL > sums.peakL ? absL : sums.peakL;
+    sums.peakR = absR > sums.peakR ? absR : sums.peakR;
+    sums.sumSquaresL += l * l;
+    sums.sumSquaresR += r * r;
+    sums.sumProducts += l * r;
+  }
+  return sums;
+}
+
+// One build of every kernel.
+template <typename SampleType>
+struct SimdKernels {
+  void (*applyStereoMatrix)(SampleType*, SampleType*, int, const StereoMatrix<SampleType>&);
+  void (*applyMidSideRamp)(SampleType*, SampleType*, int, const StereoMatrix<SampleType>&,
+                           const SampleType*, const SampleType*, const SampleType*,
+                           const SampleType*);
+  SampleType (*getMaxAbs)(const SampleType*, int);
+  LevelSums (*measureLevels)(const SampleType*, const SampleType*, int);
+
+  template <typename Ops>
+  static constexpr SimdKernels make() {
+    return {&::applyStereoMatrix<SampleType, Ops>, &::applyMidSideRamp<SampleType, Ops>,
+            &::getMaxAbs<SampleType, Ops>, &::measureLevels<SampleType, Ops>};
+  }
+
+  // nullptr when the level was not built for this target (e.g. AVX2 on ARM)
+  static const SimdKernels* get(SimdLevel level) {
+    static constexpr SimdKernels scalar = make<ScalarOps<SampleType>>();
+#if UTILITY_CLONE_HAS_SSE2
+    static constexpr SimdKernels sse2 = make<Sse2Ops<SampleType>>();
+#endif
+    switch (level) {
+      case SimdLevel::SCALAR:
+        return &scalar;
+#if UTILITY_CLONE_HAS_SSE2
+      case SimdLevel::SSE2:
+        return &sse2;
+#endif
+      case SimdLevel::AVX2:
+        return getAvx2();
+      case SimdLevel::AVX512:
+        return getAvx512();
+      default:
+        return nullptr;
+    }
+  }
+
+ private:
+  static const SimdKernels* getAvx2();
+  static const SimdKernels* getAvx512();
+};
+
+// in SimdKernelsAvx2.cpp / SimdKernelsAvx512.cpp
+template <>
+const SimdKernels<float>* SimdKernels<float>::getAvx2();
+template <>
+const SimdKernels<double>* SimdKernels<double>::getAvx2();
+template <>
+const SimdKernels<float>* SimdKernels<float>::getAvx512();
+template <>
+const SimdKernels<double>* SimdKernels<double>::getAvx512();
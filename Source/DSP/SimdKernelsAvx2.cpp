@@ -0,0 +1,29 @@
+// The kernels of SimdKernels.h built for AVX2: this file alone is compiled with AVX2
+// enabled (-mavx2, /arch:AVX2), so nothing but the kernels may be instantiated here (see
+// SimdKernels.h). Without the flag (ARM, a universal macOS build) the level is not built.
+
+#include "SimdKernels.h"
+
+#if UTILITY_CLONE_HAS_AVX2
+template <typename SampleType>
+static constexpr SimdKernels<SampleType> kernels =
+    SimdKernels<SampleType>::template make<Avx2Ops<SampleType>>();
+#endif
+
+template <>
+const SimdKernels<float>* SimdKernels<float>::getAvx2() {
+#if UTILITY_CLONE_HAS_AVX2
+  return &kernels<float>;
+#else
+  return nullptr;
+#endif
+}
+
+template <>
+const SimdKernels<double>* SimdKernels<double>::getAvx2() {
+#if UTILITY_CLONE_HAS_AVX2
+  return &kernels<double>;
+#else
+  return nullptr;
+#endif
+}
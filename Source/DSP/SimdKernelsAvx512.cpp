@@ -0,0 +1,29 @@
+// The kernels of SimdKernels.h built for AVX-512: this file alone is compiled with AVX-512
+// enabled (-mavx512f, /arch:AVX512), so nothing but the kernels may be instantiated here (see
+// SimdKernels.h). Without the flag (ARM, a universal macOS build) the level is not built.
+
+#include "SimdKernels.h"
+
+#if UTILITY_CLONE_HAS_AVX512
+template <typename SampleType>
+static constexpr SimdKernels<SampleType> kernels =
+    SimdKernels<SampleType>::template make<Avx512Ops<SampleType>>();
+#endif
+
+template <>
+const SimdKernels<float>* SimdKernels<float>::getAvx512() {
+#if UTILITY_CLONE_HAS_AVX512
+  return &kernels<float>;
+#else
+  return nullptr;
+#endif
+}
+
+template <>
+const SimdKernels<double>* SimdKernels<double>::getAvx512() {
+#if UTILITY_CLONE_HAS_AVX512
+  return &kernels<double>;
+#else
+  return nullptr;
+#endif
+}
@@ -0,0 +1,212 @@
+#pragma once
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define UTILITY_CLONE_HAS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#define UTILITY_CLONE_HAS_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if defined(__AVX512F__)
+#define UTILITY_CLONE_HAS_AVX512 1
+#endif
+
+// Thin wrappers around the vector types, so a kernel is written once as a template over Ops and
+// instantiated for every instruction set. Loads and stores are unaligned: host buffers carry no
+// alignment guarantee. A kernel walks the block in steps of Ops::size and finishes the remainder
+// with ScalarOps.
+template <typename SampleType>
+struct ScalarOps {
+  using Vector = SampleType;
+  static constexpr int size = 1;
+
+  static Vector load(const SampleType* p) { return *p; }
+  static void store(SampleType* p, Vector v) { *p = v; }
+  static Vector broadcast(SampleType v) { return v; }
+  static Vector add(Vector a, Vector b) { return a + b; }
+  static Vector sub(Vector a, Vector b) { return a - b; }
+  static Vector mul(Vector a, Vector b) { return a * b; }
+  static Vector max(Vector a, Vector b) { return a > b ? a : b; }
+  static Vector abs(Vector a) { return a < 0 ? -a : a; }
+};
+
+#if UTILITY_CLONE_HAS_SSE2
+template <typename SampleType>
+struct Sse2Ops;
+
+template <>
+struct Sse2Ops<float> {
+  using Vector = __m128;
+  static constexpr int size = 4;
+
+  static Vector load(const float* p) { return _mm_loadu_ps(p); }
+  static void store(float* p, Vector v) { _mm_storeu_ps(p, v); }
+  static Vector broadcast(float v) { return _mm_set1_ps(v); }
+  static Vector add(Vector a, Vector b) { return _mm_add_ps(a, b); }
+  static Vector sub(Vector a, Vector b) { return _mm_sub_ps(a, b); }
+  static Vector mul(Vector a, Vector b) { return _mm_mul_ps(a, b); }
+  static Vector max(Vector a, Vector b) { return _mm_max_ps(a, b); }
+  static Vector abs(Vector a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+};
+
+template <>
+struct Sse2Ops<double> {
+  using Vector = __m128d;
+  static constexpr int size = 2;
+
+  static Vector load(const double* p) { return _mm_loadu_pd(p); }
+  static void store(double* p, Vector v) { _mm_storeu_pd(p, v); }
+  static Vector broadcast(double v) { return _mm_set1_pd(v); }
+  static Vector add(Vector a, Vector b) { return _mm_add_pd(a, b); }
+  static Vector sub(Vector a, Vector b) { return _mm_sub_pd(a, b); }
+  static Vector mul(Vector a, Vector b) { return _mm_mul_pd(a, b); }
+  static Vector max(Vector a, Vector b) { return _mm_max_pd(a, b); }
+  static Vector abs(Vector a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+};
+#endif
+
+#if UTILITY_CLONE_HAS_AVX2
+template <typename SampleType>
+struct Avx2Ops;
+
+template <>
+struct Avx2Ops<float> {
+  using Vector = __m256;
+  static constexpr int size = 8;
+
+  static Vector load(const float* p) { return _mm256_loadu_ps(p); }
+  static void store(float* p, Vector v) { _mm256_storeu_ps(p, v); }
+  static Vector broadcast(float v) { return _mm256_set1_ps(v); }
+  static Vector add(Vector a, Vector b) { return _mm256_add_ps(a, b); }
+  static Vector sub(Vector a, Vector b) { return _mm256_sub_ps(a, b); }
+  static Vector mul(Vector a, Vector b) { return _mm256_mul_ps(a, b); }
+  static Vector max(Vector a, Vector b) { return _mm256_max_ps(a, b); }
+  static Vector abs(Vector a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+};
+
+template <>
+struct Avx2Ops<double> {
+  using Vector = __m256d;
+  static constexpr int size = 4;
+
+  static Vector load(const double* p) { return _mm256_loadu_pd(p); }
+  static void store(double* p, Vector v) { _mm256_storeu_pd(p, v); }
+  static Vector broadcast(double v) { return _mm256_set1_pd(v); }
+  static Vector add(Vector a, Vector b) { return _mm256_add_pd(a, b); }
+  static Vector sub(Vector a, Vector b) { return _mm256_sub_pd(a, b); }
+  static Vector mul(Vector a, Vector b) { return _mm256_mul_pd(a, b); }
+  static Vector max(Vector a, Vector b) { return _mm256_max_pd(a, b); }
+  static Vector abs(Vector a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+};
+#endif
+
+#if UTILITY_CLONE_HAS_AVX512
+template <typename SampleType>
+struct Avx512Ops;
+
+template <>
+struct Avx512Ops<float> {
+  using Vector = __m512;
+  static constexpr int size = 16;
+
+  static Vector load(const float* p) { return _mm512_loadu_ps(p); }
+  static void store(float* p, Vector v) { _mm512_storeu_ps(p, v); }
+  static Vector broadcast(float v) { return _mm512_set1_ps(v); }
+  static Vector add(Vector a, Vector b) { return _mm512_add_ps(a, b); }
+  static Vector sub(Vector a, Vector b) { return _mm512_sub_ps(a, b); }
+  static Vector mul(Vector a, Vector b) { return _mm512_mul_ps(a, b); }
+  // the zero-masked form: GCC 12 warns about the undefined pass-through of _mm512_max_ps
+  static Vector max(Vector a, Vector b) { return _mm512_maskz_max_ps(0xffff, a, b); }
+  static Vector abs(Vector a) { return _mm512_abs_ps(a); }
+};
+
+template <>
+struct Avx512Ops<double> {
+  using Vector = __m512d;
+  static constexpr int size = 8;
+
+  static Vector load(const double* p) { return _mm512_loadu_pd(p); }
+  static void store(double* p, Vector v) { _mm512_storeu_pd(p, v); }
+  static Vector broadcast(double v) { return _mm512_set1_pd(v); }
+  static Vector add(Vector a, Vector b) { return _mm512_add_pd(a, b); }
+  static Vector sub(Vector a, Vector b) { return _mm512_sub_pd(a, b); }
+  static Vector mul(Vector a, Vector b) { return _mm512_mul_pd(a, b); }
+  static Vector max(Vector a, Vector b) { return _mm512_maskz_max_pd(0xff, a, b); }
+  static Vector abs(Vector a) { return _mm512_abs_pd(a); }
+};
+#endif
+
+// The two channels of a pair side by side in one register, for recursive filters which cannot be
+// vectorised over time: one instruction updates the left and the right state. Float only uses
+// the low half of the SSE register. Without SSE2 the pair is a plain struct.
+template <typename SampleType>
+struct StereoOps {
+  struct Vector {
+    SampleType left, right;
+  };
+
+  static Vector make(SampleType left, SampleType right) { return {left, right}; }
+  static SampleType getLeft(Vector v) { return v.left; }
+  static SampleType getRight(Vector v) { return v.right; }
+  static Vector broadcast(SampleType v) { return {v, v}; }
+  static Vector add(Vector a, Vector b) { return {a.left + b.left, a.right + b.right}; }
+  static Vector sub(Vector a, Vector b) { return {a.left - b.left, a.right - b.right}; }
+  static Vector mul(Vector a, Vector b) { return {a.left * b.left, a.right * b.right}; }
+};
+
+#if UTILITY_CLONE_HAS_SSE2
+template <>
+struct StereoOps<float> : Sse2Ops<float> {
+  static Vector make(float left, float right) { return _mm_setr_ps(left, right, 0.0f, 0.0f); }
+  static float getLeft(Vector v) { return _mm_cvtss_f32(v); }
+  static float getRight(Vector v) {
+    return _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)));
+  }
+};
+
+template <>
+struct StereoOps<double> : Sse2Ops<double> {
+  static Vector make(double left, double right) { return _mm_setr_pd(left, right); }
+  static double getLeft(Vector v) { return _mm_cvtsd_f64(v); }
+  static double getRight(Vector v) { return _mm_cvtsd_f64(_mm_unpackhi_pd(v, v)); }
+};
+#endif
+
+// sum / maximum of the lanes of a vector, for the end of a reduction
+template <typename Ops, typename SampleType>
+SampleType reduceAdd(typename Ops::Vector v) {
+  alignas(32) SampleType lanes[Ops::size];
+  Ops::store(lanes, v);
+  SampleType result = 0;
+  for (auto lane : lanes) result += lane;
+  return result;
+}
+
+template <typename Ops, typename SampleType>
+SampleType reduceMax(typename Ops::Vector v) {
+  alignas(32) SampleType lanes[Ops::size];
+  Ops::store(lanes, v);
+  SampleType result = lanes[0];
+  for (auto lane : lanes) result = lane > result ? lane : result;
+  return result;
+}
+
+// Widest instruction set this translation unit is compiled for. The plugin's own sources are
+// built for the baseline (SSE2 on x86-64); the kernels in SimdKernels.h also get AVX2 and AVX-512
+// builds, chosen at runtime.
+#if UTILITY_CLONE_HAS_AVX512
+template <typename SampleType>
+using NativeOps = Avx512Ops<SampleType>;
+#elif UTILITY_CLONE_HAS_AVX2
+template <typename SampleType>
+using NativeOps = Avx2Ops<SampleType>;
+#elif UTILITY_CLONE_HAS_SSE2
+template <typename SampleType>
+using NativeOps = Sse2Ops<SampleType>;
+#else
+template <typename SampleType>
+using NativeOps = ScalarOps<SampleType>;
+#endif
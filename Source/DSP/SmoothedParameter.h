@@ -0,0 +1,153 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+
+#include "SimdOps.h"
+
+// A value gliding to its target over a fixed time, on a linear or a multiplicative (constant
+// ratio per sample, i.e. linear in dB) curve, with the same steps as juce::SmoothedValue. Instead
+// of one getNextValue() per sample, fill() renders a chunk of the ramp at once: sample n of a
+// linear ramp is current + n * step and of a multiplicative one current * step^n, so Ops::size
+// lanes advance per iteration. The last sample of a ramp is exactly the target.
+template <typename SampleType>
+class SmoothedParameter {
+ public:
+  enum class Curve { LINEAR, MULTIPLICATIVE };
+
+  // a multiplicative curve needs a non-zero value of the same sign as every target
+  explicit SmoothedParameter(SampleType initialValue = 0, Curve curveToUse = Curve::LINEAR)
+      : curve(curveToUse), current(initialValue), target(initialValue) {}
+
+  void prepare(double sampleRate, double rampSeconds) {
+    rampLength = static_cast<int>(std::floor(rampSeconds * sampleRate));
+    setCurrentAndTargetValue(target);
+  }
+
+  void setTargetValue(SampleType value) {
+    if (value == target) return;
+    if (rampLength <= 0) {
+      setCurrentAndTargetValue(value);
+      return;
+    }
+
+    target = value;
+    countdown = rampLength;
+    step = curve == Curve::LINEAR
+               ? (target - current) / static_cast<SampleType>(countdown)
+               : std::exp((std::log(std::abs(target)) - std::log(std::abs(current))) /
+                          static_cast<SampleType>(countdown));
+  }
+
+  void setCurrentAndTargetValue(SampleType value) {
+    current = target = value;
+    countdown = 0;
+  }
+
+  SampleType getCurrentValue() const { return current; }
+  SampleType getTargetValue() const { return target; }
+  bool isSmoothing() const { return countdown > 0; }
+
+  // advances by numSamples without rendering them, returns the new current value
+  SampleType skip(int numSamples) {
+    if (numSamples >= countdown) {
+      setCurrentAndTargetValue(target);
+      return target;
+    }
+
+    if (curve == Curve::LINEAR)
+      current += step * static_cast<SampleType>(numSamples);
+    else
+      current *= std::pow(step, static_cast<SampleType>(numSamples));
+    countdown -= numSamples;
+    return current;
+  }
+
+  // the next numSamples values, the target once the ramp has run out
+  void fill(SampleType* ramp, int numSamples) {
+    const int numRamp = juce::jmin(numSamples, countdown);
+    if (numRamp > 0) {
+      if (curve == Curve::LINEAR)
+        fillLinear(ramp, numRamp);
+      else
+        fillMultiplicative(ramp, numRamp);
+
+      countdown -= numRamp;
+      if (countdown == 0) ramp[numRamp - 1] = target;
+      current = ramp[numRamp - 1];
+    }
+    for (int i = numRamp; i < numSamples; ++i) ramp[i] = target;
+  }
+
+ private:
+  using Ops = NativeOps<SampleType>;
+
+  void fillLinear(SampleType* ramp, int numSamples) const {
+    // offsets from the current value instead of a running sum, so the error does not accumulate
+    alignas(32) std::array<SampleType, Ops::size> counts{};
+    for (int lane = 0; lane < Ops::size; ++lane) counts[lane] = static_cast<SampleType>(lane + 1);
+
+    auto count = Ops::load(counts.data());
+    const auto advance = Ops::broadcast(static_cast<SampleType>(Ops::size));
+    const auto start = Ops::broadcast(current);
+    const auto stepVector = Ops::broadcast(step);
+    int i = 0;
+    for (; i + Ops::size <= numSamples; i += Ops::size) {
+      Ops::store(ramp + i, Ops::add(start, Ops::mul(count, stepVector)));
+      count = Ops::add(count, advance);
+    }
+    for (; i < numSamples; ++i) ramp[i] = current + static_cast<SampleType>(i + 1) * step;
+  }
+
+  void fillMultiplicative(SampleType* ramp, int numSamples) const {
+    alignas(32) std::array<SampleType, Ops::size> powers{};
+    auto power = step;
+    for (int lane = 0; lane < Ops::size; ++lane) {
+      powers[lane] = power;
+      power *= step;
+    }
+
+    auto value = Ops::mul(Ops::broadcast(current), Ops::load(powers.data()));
+    const auto advance = Ops::broadcast(powers[Ops::size - 1]);
+    int i = 0;
+    for (; i + Ops::size <= numSamples; i += Ops::size) {
+      Ops::store(ramp + i, value);
+      value = Ops::mul(value, advance);
+    }
+    for (auto previous = i > 0 ? ramp[i - 1] : current; i < numSamples; ++i)
+      previous = ramp[i] = previous * step;
+  }
+
+  Curve curve;
+  SampleType current, target;
+  SampleType step = 0;
+  int countdown = 0;
+  int rampLength = 0;
+};
+
+// A fixed set of smoothed parameters addressed by an enum. Settled once none of them is ramping,
+// which is when a kernel can switch to constant coefficients.
+template <typename SampleType, int numParameters>
+class SmoothedParameters {
+ public:
+  SmoothedParameter<SampleType>& operator[](int index) {
+    return parameters[static_cast<size_t>(index)];
+  }
+  const SmoothedParameter<SampleType>& operator[](int index) const {
+    return parameters[static_cast<size_t>(index)];
+  }
+
+  bool isSettled() const {
+    for (const auto& parameter : parameters)
+      if (parameter.isSmoothing()) return false;
+    return true;
+  }
+
+  void snapToTargets() {
+    for (auto& parameter : parameters)
+      parameter.setCurrentAndTargetValue(parameter.getTargetValue());
+  }
+
+ private:
+  std::array<SmoothedParameter<SampleType>, numParameters> parameters;
+};
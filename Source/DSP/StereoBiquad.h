@@ -0,0 +1,90 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "ChannelGroups.h"
+#include "SimdOps.h"
+
+// Second order IIR with the same transposed direct form II difference equations as
+// juce::dsp::IIR::Filter, run on the channel groups: a pair's left and right states share one
+// StereoOps register, single channels use the scalar recursion.
+template <typename SampleType>
+class StereoBiquad {
+ public:
+  void prepare(int numChannels) { state.assign(static_cast<size_t>(numChannels), State()); }
+
+  void reset() { std::fill(state.begin(), state.end(), State()); }
+
+  // juce::dsp::IIR::Coefficients of order 2, e.g. from makeHighPass()
+  void setCoefficients(const juce::dsp::IIR::Coefficients<SampleType>& coefficients) {
+    jassert(coefficients.getFilterOrder() == 2);
+    const auto* c = coefficients.getRawCoefficients();
+    b0 = c[0], b1 = c[1], b2 = c[2], a1 = c[3], a2 = c[4];
+  }
+
+  // every channel's state within threshold of 0, so silence in gives silence out
+  bool isDecayed(SampleType threshold) const {
+    return std::all_of(state.begin(), state.end(), [threshold](const State& s) {
+      return std::abs(s.s1) <= threshold && std::abs(s.s2) <= threshold;
+    });
+  }
+
+  void process(juce::AudioBuffer<SampleType>& buffer, int startSample, int numSamples,
+               const ChannelGroups& groups) {
+    const auto vb0 = Ops::broadcast(b0), vb1 = Ops::broadcast(b1), vb2 = Ops::broadcast(b2);
+    const auto va1 = Ops::broadcast(a1), va2 = Ops::broadcast(a2);
+    for (int p = 0; p < groups.numPairs; ++p) {
+      const auto channels = groups.pairs[static_cast<size_t>(p)];
+      auto* left = buffer.getWritePointer(channels.left, startSample);
+      auto* right = buffer.getWritePointer(channels.right, startSample);
+      const auto& stateL = state[static_cast<size_t>(channels.left)];
+      const auto& stateR = state[static_cast<size_t>(channels.right)];
+
+      auto s1 = Ops::make(stateL.s1, stateR.s1);
+      auto s2 = Ops::make(stateL.s2, stateR.s2);
+      for (int i = 0; i < numSamples; ++i) {
+        const auto x = Ops::make(left[i], right[i]);
+        const auto y = Ops::add(Ops::mul(vb0, x), s1);
+        s1 = Ops::add(Ops::sub(Ops::mul(vb1, x), Ops::mul(va1, y)), s2);
+        s2 = Ops::sub(Ops::mul(vb2, x), Ops::mul(va2, y));
+        left[i] = Ops::getLeft(y);
+        right[i] = Ops::getRight(y);
+      }
+      storeState(channels.left, Ops::getLeft(s1), Ops::getLeft(s2));
+      storeState(channels.right, Ops::getRight(s1), Ops::getRight(s2));
+    }
+
+    for (int k = 0; k < groups.numSingles; ++k) {
+      const int channel = groups.singles[static_cast<size_t>(k)];
+      auto* data = buffer.getWritePointer(channel, startSample);
+      auto [s1, s2] = state[static_cast<size_t>(channel)];
+      for (int i = 0; i < numSamples; ++i) {
+        const auto x = data[i];
+        const auto y = b0 * x + s1;
+        s1 = b1 * x - a1 * y + s2;
+        s2 = b2 * x - a2 * y;
+        data[i] = y;
+      }
+      storeState(channel, s1, s2);
+    }
+  }
+
+ private:
+  using Ops = StereoOps<SampleType>;
+
+  struct State {
+    SampleType s1 = 0, s2 = 0;
+  };
+
+  // like IIR::Filter, once per block
+  void storeState(int channel, SampleType s1, SampleType s2) {
+    JUCE_SNAP_TO_ZERO(s1);
+    JUCE_SNAP_TO_ZERO(s2);
+    state[static_cast<size_t>(channel)] = {s1, s2};
+  }
+
+  SampleType b0 = 1, b1 = 0, b2 = 0, a1 = 0, a2 = 0;  // normalised, a0 = 1
+  std::vector<State> state;  // per channel
+};
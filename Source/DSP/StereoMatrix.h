@@ -0,0 +1,32 @@
+#pragma once
+
+// 2x2 gain matrix applied to a left/right sample pair:
+//   left  = ll * left + lr * right
+//   right = rl * left + rr * right
+// Phase, channel mode, width, mid/side, mono, gain and pan are all of this form, so they are
+// multiplied together first and applied to the buffer in a single pass (see SimdKernels.h).
+template <typename SampleType>
+struct StereoMatrix {
+  SampleType ll = 1, lr = 0, rl = 0, rr = 1;
+
+  static StereoMatrix diagonal(SampleType left, SampleType right) { return {left, 0, 0, right}; }
+
+  // scale mid (L + R) and side (R - L) independently
+  static StereoMatrix midSide(SampleType midScale, SampleType sideScale) {
+    const SampleType h = (midScale + sideScale) / 2;
+    const SampleType d = (midScale - sideScale) / 2;
+    return {h, d, d, h};
+  }
+
+  StereoMatrix operator*(const StereoMatrix& o) const {
+    return {ll * o.ll + lr * o.rl, ll * o.lr + lr * o.rr, rl * o.ll + rr * o.rl,
+            rl * o.lr + rr * o.rr};
+  }
+
+  void apply(SampleType& left, SampleType& right) const {
+    const auto l = left;
+    const auto r = right;
+    left = ll * l + lr * r;
+    right = rl * l + rr * r;
+  }
+};
@@ -0,0 +1,120 @@
+#pragma once
+
+// Where the time of processBlock goes, stage by stage, for chrome://tracing or
+// ui.perfetto.dev. Only in a build configured with -DUTILITY_CLONE_TRACE=ON; otherwise
+// UTILITY_CLONE_TRACE_SCOPE expands to nothing and this header declares nothing else.
+//
+// A scope takes a timestamp on entry and on exit and stores one complete event in the ring of its
+// thread. The rings are static, and a thread claims one with claimThread() before it processes,
+// so recording is a pointer lookup which neither allocates nor locks; threads which have not
+// claimed a ring are not recorded. Each ring keeps the last `capacity` events of its thread. The
+// tools write them out with writeJson() once processing has stopped.
+#ifndef UTILITY_CLONE_TRACE
+#define UTILITY_CLONE_TRACE 0
+#endif
+
+#if UTILITY_CLONE_TRACE
+
+#include <juce_core/juce_core.h>
+
+#include <array>
+#include <atomic>
+
+#define UTILITY_CLONE_TRACE_SCOPE(name) \
+  const Trace::Scope JUCE_JOIN_MACRO(traceScope, __LINE__)(name)
+
+class Trace {
+ public:
+  static constexpr int maxThreads = 16;  // later threads are not recorded
+  static constexpr int capacity = 1 << 14;
+
+  class Scope {
+   public:
+    explicit Scope(const char* nameToUse)
+        : name(nameToUse), start(juce::Time::getHighResolutionTicks()) {}
+    ~Scope() { add(name, start, juce::Time::getHighResolutionTicks()); }
+
+   private:
+    const char* const name;  // a string literal
+    const juce::int64 start;
+
+    JUCE_DECLARE_NON_COPYABLE(Scope)
+  };
+
+  // Gives the calling thread a ring, if it has none yet and one is left. Call it before the
+  // thread processes, not from processBlock.
+  static void claimThread() {
+    if (threadRing == nullptr) threadRing = claimRing();
+  }
+
+  // Every recorded event as Chrome trace JSON, one tid per thread. An event written while this
+  // runs may come out torn, so call it after processing has stopped.
+  static void writeJson(juce::OutputStream& out) {
+    const auto toMicroseconds = [](juce::int64 ticks) {
+      return juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e6;
+    };
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    const char* separator = "\n";
+    const int numThreads = juce::jmin(getNumClaimed().load(std::memory_order_acquire), maxThreads);
+    for (int thread = 0; thread < numThreads; ++thread) {
+      const auto& ring = getRings()[static_cast<size_t>(thread)];
+      const auto numEvents = ring.numEvents.load(std::memory_order_acquire);
+      const auto first = numEvents > capacity ? numEvents - capacity : 0;
+      for (auto i = first; i < numEvents; ++i) {
+        const auto& event = ring.events[i % capacity];
+        out << separator << "{\"name\":\"" << event.name
+            << "\",\"cat\":\"dsp\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread
+            << ",\"ts\":" << juce::String(toMicroseconds(event.start), 3)
+            << ",\"dur\":" << juce::String(toMicroseconds(event.end - event.start), 3) << "}";
+        separator = ",\n";
+      }
+    }
+    out << "\n]}\n";
+  }
+
+ private:
+  struct Event {
+    const char* name;
+    juce::int64 start, end;
+  };
+
+  struct Ring {
+    std::atomic<juce::uint64> numEvents{0};
+    std::array<Event, capacity> events;
+  };
+
+  static std::array<Ring, maxThreads>& getRings() {
+    static std::array<Ring, maxThreads> rings;
+    return rings;
+  }
+
+  static std::atomic<int>& getNumClaimed() {
+    static std::atomic<int> numClaimed{0};
+    return numClaimed;
+  }
+
+  static Ring* claimRing() {
+    const int index = getNumClaimed().fetch_add(1, std::memory_order_acq_rel);
+    return index < maxThreads ? &getRings()[static_cast<size_t>(index)] : nullptr;
+  }
+
+  // constant initialised, so reading it needs no guard for a first use
+  static inline thread_local Ring* threadRing = nullptr;
+
+  // the thread owning the ring is its only writer
+  static void add(const char* name, juce::int64 start, juce::int64 end) {
+    auto* const ring = threadRing;
+    if (ring == nullptr) return;
+
+    const auto index = ring->numEvents.load(std::memory_order_relaxed);
+    ring->events[index % capacity] = {name, start, end};
+    ring->numEvents.store(index + 1, std::memory_order_release);
+  }
+};
+
+#else
+
+#define UTILITY_CLONE_TRACE_SCOPE(name)
+
+#endif
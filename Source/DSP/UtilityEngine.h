@@ -0,0 +1,497 @@
+#pragma once
+
+#include <array>
+#include <utility>
+
+#include "ChannelGroups.h"
+#include "LinearPhaseCrossover.h"
+#include "LinkwitzRileyCrossover.h"
+#include "ProcessingPlan.h"
+#include "ScratchArena.h"
+#include "SimdDispatch.h"
+#include "SmoothedParameter.h"
+#include "StereoBiquad.h"
+#include "StereoMatrix.h"
+#include "Trace.h"
+
+// All of the plugin's DSP state, templated on the sample type so the processor can run a float
+// and a double instance side by side. The processor owns the parameters and builds the plan;
+// the engine only turns a ParameterSnapshot into audio.
+template <typename SampleType>
+class UtilityEngine {
+ public:
+  using Matrix = StereoMatrix<SampleType>;
+
+  void prepare(const juce::dsp::ProcessSpec& spec) {
+    smoothers[WIDTH].prepare(spec.sampleRate, 0.001);
+    smoothers[MID_SIDE].prepare(spec.sampleRate, 0.001);
+    // the ramp of the former juce::dsp::Gain. juce::dsp::Panner ramped its channel gains over
+    // 50 ms; the pan now takes the 5 ms of the gain instead, as both are multiplied into the same
+    // per-channel output gains and a single ramp time keeps them arriving together
+    smoothers[GAIN].prepare(spec.sampleRate, 0.005);
+    smoothers[PAN_L].prepare(spec.sampleRate, 0.005);
+    smoothers[PAN_R].prepare(spec.sampleRate, 0.005);
+
+    lrFilter.prepare(spec);
+    linearPhaseCrossover.prepare(spec);
+    scratch.prepare(NUM_SCRATCH_SLOTS, static_cast<int>(spec.maximumBlockSize));
+
+    dcFilter.setCoefficients(*juce::dsp::IIR::Coefficients<SampleType>::makeHighPass(
+        spec.sampleRate, static_cast<SampleType>(5.0)));
+    dcFilter.prepare(static_cast<int>(spec.numChannels));
+
+    fadeLength = juce::jmax(1, static_cast<int>(spec.sampleRate * 0.005));
+    dry.setSize(static_cast<int>(spec.numChannels), fadeLength);
+    isBypassed = false;
+    fadePosition = fadeLength;
+  }
+
+  void reset() {
+    lrFilter.reset();
+    linearPhaseCrossover.reset();
+    dcFilter.reset();
+  }
+
+  // what the processor reports to the host while the linear-phase crossover is selected
+  int getLinearPhaseLatency() const { return linearPhaseCrossover.getLatencySamples(); }
+
+  // the linear-phase kernels of a slope, see LinearPhaseCrossover::loadSlope()
+  void loadLinearPhaseSlope(int dbPerOctave) { linearPhaseCrossover.loadSlope(dbPerOctave); }
+
+  // start from the current parameters instead of ramping up from 0 on the first block
+  void snapToParameters(const ParameterSnapshot& params) {
+    setTargets(params);
+    smoothers.snapToTargets();
+    lrFilter.snapToCutoffFrequency(static_cast<SampleType>(params.bassMonoFrequency));
+  }
+
+  // numSamples from startSample, so a block can be split where a parameter changes
+  void process(juce::AudioBuffer<SampleType>& buffer, int startSample, int numSamples,
+               const ChannelGroups& groups, const ParameterSnapshot& params,
+               const ProcessingPlan& plan) {
+    setTargets(params);
+    selectCrossover(params);
+
+    // the first block after bypass(): keep the dry input to fade from
+    if (isBypassed) {
+      isBypassed = false;
+      fadePosition = 0;
+    }
+    const int numFade = juce::jmin(numSamples, fadeLength - fadePosition);
+    const int numFadeChannels = juce::jmin(buffer.getNumChannels(), dry.getNumChannels());
+    for (int channel = 0; channel < numFadeChannels && numFade > 0; ++channel)
+      dry.copyFrom(channel, 0, buffer, channel, startSample, numFade);
+
+    if (isLinearPhase) {
+      // only what processBassMono() reads is convolved: the side for Bass Mono, the mid too for
+      // listening, nothing while the stage is off
+      const bool isBassMono = plan.has(ProcessingPlan::Stage::BASS_MONO);
+      linearPhaseCrossover.setBands(
+          groups, isBassMono && params.isBassMonoListening,
+          isBassMono && !(params.isBassMono && params.isBassMonoListening));
+
+      UTILITY_CLONE_TRACE_SCOPE("delay");
+      delayUnfilteredChannels(buffer, startSample, numSamples, groups, plan);
+    }
+
+    processGroups(buffer, startSample, numSamples, groups, params, plan);
+
+    if (plan.has(ProcessingPlan::Stage::DC)) {
+      UTILITY_CLONE_TRACE_SCOPE("dc");
+      dcFilter.process(buffer, startSample, numSamples, groups);
+    }
+
+    if (numFade > 0) {
+      UTILITY_CLONE_TRACE_SCOPE("fade");
+      fadeFromDry(buffer, startSample, numFade, numFadeChannels);
+    }
+  }
+
+  // The fast path for neutral settings: true when process() would leave the buffer as it is, so
+  // the caller can skip it. That is when the plan is the identity and every ramp has arrived
+  // there; a parameter leaving neutral ramps away from it as usual, and the next process() fades
+  // in from the dry input over 5 ms, so a switch (phase, channel mode, DC...) does not click.
+  bool bypass(const ParameterSnapshot& params, const ProcessingPlan& plan) {
+    // a crossover switch has to go through process(), which drops the old state
+    if (!plan.isIdentity() || params.isBassMonoLinearPhase != isLinearPhase) return false;
+
+    setTargets(params);
+    if (!smoothers.isSettled()) return false;
+    isBypassed = true;
+    return true;
+  }
+
+  // the gain and pan ramps which have not arrived at the snapshot's values yet
+  ProcessingPlan::Ramps getRamps(const ParameterSnapshot& params) const {
+    const auto [panL, panR] = getPanTargets(params.pan);
+    return {isMovingTo(GAIN, getGainTarget(params.gain)),
+            isMovingTo(PAN_L, panL) || isMovingTo(PAN_R, panR)};
+  }
+
+  //==============================================================================
+  // Digital silence on every channel of the groups: a max |x| over the block, Ops::size lanes at
+  // a time, stopping at the first channel with a non-zero sample.
+  bool isSilent(const juce::AudioBuffer<SampleType>& buffer, const ChannelGroups& groups) const {
+    const auto isChannelSilent = [&](int channel) {
+      return kernels.getMaxAbs(buffer.getReadPointer(channel), buffer.getNumSamples()) ==
+             SampleType();
+    };
+    for (int p = 0; p < groups.numPairs; ++p)
+      if (!isChannelSilent(groups.pairs[p].left) || !isChannelSilent(groups.pairs[p].right))
+        return false;
+    for (int s = 0; s < groups.numSingles; ++s)
+      if (!isChannelSilent(groups.singles[s])) return false;
+    return true;
+  }
+
+  // True when process() would turn silence into silence: every filter the plan runs has rung out
+  // below decayThreshold, and the linear-phase crossover has seen silence for longer than its
+  // tail. The gain and the matrix are memoryless, so they cannot add anything.
+  bool isDecayed(int numSilentSamples, const ParameterSnapshot& params,
+                 const ProcessingPlan& plan) const {
+    if (params.isBassMonoLinearPhase != isLinearPhase) return false;  // process() resets first
+    if (isLinearPhase) {
+      if (numSilentSamples < linearPhaseCrossover.getTailSamples()) return false;
+    } else if (plan.has(ProcessingPlan::Stage::BASS_MONO) && !lrFilter.isDecayed(decayThreshold)) {
+      return false;
+    }
+    return !plan.has(ProcessingPlan::Stage::DC) || dcFilter.isDecayed(decayThreshold);
+  }
+
+  // In place of process() for a silent block while isDecayed(): the buffer is left as it is, the
+  // ramps and the crossover's cutoff move on as if it had been processed.
+  void skip(int numSamples, const ParameterSnapshot& params, const ProcessingPlan& plan) {
+    setTargets(params);
+    for (int id = 0; id < NUM_SMOOTHED; ++id) smoothers[id].skip(numSamples);
+    if (plan.has(ProcessingPlan::Stage::BASS_MONO) && !isLinearPhase) lrFilter.skip(numSamples);
+
+    // silence was bypassed and silence came out, there is nothing to fade from
+    isBypassed = false;
+    fadePosition = fadeLength;
+  }
+
+ private:
+  // -240 dB: what is left in the 48 dB/oct cascade then reaches the output about 20 dB louder,
+  // still far below the 24 bit noise floor after the full +35 dB of gain
+  static constexpr auto decayThreshold = static_cast<SampleType>(1.0e-12);
+
+  static Matrix getChannelModeMatrix(ChannelMode mode) {
+    switch (mode) {
+      case ChannelMode::LEFT:
+        return {1, 0, 1, 0};
+      case ChannelMode::RIGHT:
+        return {0, 1, 0, 1};
+      case ChannelMode::SWAP:
+        return {0, 1, 1, 0};
+      default:
+        return {};
+    }
+  }
+
+  // linear from the dry input to the processed output, continuing across calls
+  void fadeFromDry(juce::AudioBuffer<SampleType>& buffer, int startSample, int numSamples,
+                   int numChannels) {
+    const auto step = static_cast<SampleType>(1) / static_cast<SampleType>(fadeLength);
+    for (int channel = 0; channel < numChannels; ++channel) {
+      const auto* in = dry.getReadPointer(channel);
+      auto* out = buffer.getWritePointer(channel, startSample);
+      for (int i = 0; i < numSamples; ++i)
+        out[i] = in[i] + (out[i] - in[i]) * static_cast<SampleType>(fadePosition + i + 1) * step;
+    }
+    fadePosition += numSamples;
+  }
+
+  // Switching crossovers changes the latency anyway, so the old state is simply dropped.
+  // While linear phase is selected every channel is delayed, whether Bass Mono is on or not.
+  void selectCrossover(const ParameterSnapshot& params) {
+    if (params.isBassMonoLinearPhase == isLinearPhase) return;
+    isLinearPhase = params.isBassMonoLinearPhase;
+    lrFilter.reset();
+    linearPhaseCrossover.reset();
+  }
+
+  void setTargets(const ParameterSnapshot& params) {
+    smoothers[WIDTH].setTargetValue(static_cast<SampleType>(params.stereoWidth));
+    smoothers[MID_SIDE].setTargetValue(static_cast<SampleType>(params.stereoMidSide));
+    lrFilter.setCutoffFrequency(static_cast<SampleType>(params.bassMonoFrequency));
+    lrFilter.setSlope(params.bassMonoSlope);
+    linearPhaseCrossover.setCutoffFrequency(static_cast<SampleType>(params.bassMonoFrequency));
+    linearPhaseCrossover.setSlope(params.bassMonoSlope);
+    smoothers[GAIN].setTargetValue(getGainTarget(params.gain));
+    const auto [panL, panR] = getPanTargets(params.pan);
+    smoothers[PAN_L].setTargetValue(panL);
+    smoothers[PAN_R].setTargetValue(panR);
+  }
+
+  static SampleType getGainTarget(float gainDecibels) {
+    return juce::Decibels::decibelsToGain(static_cast<SampleType>(gainDecibels),
+                                          static_cast<SampleType>(-100.0));
+  }
+
+  // same law as juce::dsp::Panner with PannerRule::sin3dB
+  static std::pair<SampleType, SampleType> getPanTargets(float pan) {
+    const auto normalisedPan = 0.5 * (pan / 50.0 + 1.0);
+    const auto halfPi = juce::MathConstants<double>::halfPi;
+    const auto boost = juce::MathConstants<SampleType>::sqrt2;
+    return {static_cast<SampleType>(std::sin(halfPi * (1.0 - normalisedPan))) * boost,
+            static_cast<SampleType>(std::sin(halfPi * normalisedPan)) * boost};
+  }
+
+  // ramping, or settled somewhere else than the value about to become its target
+  bool isMovingTo(int id, SampleType target) const {
+    return smoothers[id].isSmoothing() || smoothers[id].getCurrentValue() != target;
+  }
+
+  // the crossover delays the pairs it filters itself
+  void delayUnfilteredChannels(juce::AudioBuffer<SampleType>& buffer, int startSample,
+                               int numSamples, const ChannelGroups& groups,
+                               const ProcessingPlan& plan) {
+    const auto delay = [&](int channel) {
+      linearPhaseCrossover.delay(channel, buffer.getWritePointer(channel, startSample), numSamples);
+    };
+    if (!plan.has(ProcessingPlan::Stage::BASS_MONO)) {
+      for (int p = 0; p < groups.numPairs; ++p) {
+        delay(groups.pairs[p].left);
+        delay(groups.pairs[p].right);
+      }
+    }
+    for (int s = 0; s < groups.numSingles; ++s) delay(groups.singles[s]);
+  }
+
+  // Everything except the crossover and the DC filter is folded into one 2x2 matrix per sample
+  // (or one per chunk when nothing is ramping), so the buffer is walked once. The result matches
+  // the former stage-by-stage chain to float rounding: max abs error < 1e-6 for signals up to
+  // +20 dBFS. The smoothers are rendered once per chunk and the coefficients are shared by every
+  // channel pair, so a wide bus only adds the matrix pass per pair. For the same reason the trace
+  // has no scope per stage: phase, channel mode, stereo, mono, gain and pan all run in "matrix",
+  // or in "bass mono" together with the crossover.
+  void processGroups(juce::AudioBuffer<SampleType>& buffer, int startSample, int numSamples,
+                     const ChannelGroups& groups, const ParameterSnapshot& params,
+                     const ProcessingPlan& plan) {
+    using Stage = ProcessingPlan::Stage;
+    using FVO = juce::FloatVectorOperations;
+    constexpr SampleType one = 1;
+    constexpr SampleType zero = 0;
+
+    // phase, then channel mode
+    auto routing = Matrix::diagonal(params.isInvertPhaseL ? -one : one,
+                                    params.isInvertPhaseR ? -one : one);
+    if (plan.has(Stage::CHANNEL_MODE)) routing = getChannelModeMatrix(params.channelMode) * routing;
+    const SampleType singlePhase = params.isInvertPhaseL ? -one : one;
+
+    const bool isWidth = plan.has(Stage::WIDTH);
+    const bool isMidSide = plan.has(Stage::MID_SIDE);
+    const bool isBassMono = plan.has(Stage::BASS_MONO);
+    auto* stereoSmoother =
+        isWidth ? &smoothers[WIDTH] : (isMidSide ? &smoothers[MID_SIDE] : nullptr);
+
+    // mid and side scale of the stereo stage, mono being a side scale of 0.
+    // Width is 0 to 400, Mid/Side is -100 (mid only) to 100 (side only).
+    const SampleType constantSideScale = plan.has(Stage::MONO) ? zero : one;
+    const auto getMidScale = [&](SampleType value) {
+      return isMidSide ? one - juce::jmax(value, zero) / 100 : one;
+    };
+    const auto getSideScale = [&](SampleType value) {
+      if (isWidth) return value / 100;
+      if (isMidSide) return one + juce::jmin(value, zero) / 100;
+      return constantSideScale;
+    };
+
+    const int chunkSize = scratch.getBlockSize();
+    const int kernelFeatures = isBassMono ? getKernelFeatures(params) : 0;
+
+    for (int offset = 0; offset < numSamples; offset += chunkSize) {
+      const int start = startSample + offset;
+      const int num = juce::jmin(chunkSize, numSamples - offset);
+      if (isBassMono && !isLinearPhase) lrFilter.prepareChunk(num);
+      // the stereo smoother not in use runs out its ramp unheard, so it cannot hold off the
+      // settled path
+      for (const int id : {WIDTH, MID_SIDE})
+        if (&smoothers[id] != stereoSmoother) smoothers[id].skip(num);
+
+      if (smoothers.isSettled()) {
+        const auto value = stereoSmoother != nullptr ? stereoSmoother->getTargetValue() : zero;
+        const auto pre = Matrix::midSide(getMidScale(value), getSideScale(value)) * routing;
+        const auto gainValue = smoothers[GAIN].getTargetValue();
+        const auto post = Matrix::diagonal(gainValue * smoothers[PAN_L].getTargetValue(),
+                                           gainValue * smoothers[PAN_R].getTargetValue());
+        const auto matrix = post * pre;
+
+        UTILITY_CLONE_TRACE_SCOPE(isBassMono ? "bass mono" : "matrix");
+        for (int p = 0; p < groups.numPairs; ++p) {
+          const auto pair = groups.pairs[p];
+          auto* left = buffer.getWritePointer(pair.left, start);
+          auto* right = buffer.getWritePointer(pair.right, start);
+          if (isBassMono) {
+            dispatch(kernelFeatures, [&](auto features) {
+              processBassMono<features>(
+                  left, right, pair, num, [&](int) { return pre; }, [&](int) { return post; });
+            });
+          } else {
+            kernels.applyStereoMatrix(left, right, num, matrix);
+          }
+        }
+        for (int s = 0; s < groups.numSingles; ++s) {
+          auto* data = buffer.getWritePointer(groups.singles[s], start);
+          FVO::multiply(data, singlePhase * gainValue, num);
+          if (isBassMono && !isLinearPhase) lrFilter.processAllpass(groups.singles[s], data, num);
+        }
+        continue;
+      }
+
+      // render every smoother's ramp for the chunk
+      auto* midScale = scratch.getSlot(MID_SCALE);
+      auto* sideScale = scratch.getSlot(SIDE_SCALE);
+      auto* gainRamp = scratch.getSlot(GAIN_RAMP);
+      auto* outputGainL = scratch.getSlot(OUTPUT_GAIN_L);
+      auto* outputGainR = scratch.getSlot(OUTPUT_GAIN_R);
+
+      {
+        UTILITY_CLONE_TRACE_SCOPE("ramps");
+        if (stereoSmoother != nullptr) {
+          stereoSmoother->fill(sideScale, num);
+          for (int i = 0; i < num; ++i) {
+            midScale[i] = getMidScale(sideScale[i]);
+            sideScale[i] = getSideScale(sideScale[i]);
+          }
+        } else {
+          FVO::fill(midScale, one, num);
+          FVO::fill(sideScale, constantSideScale, num);
+        }
+        smoothers[GAIN].fill(gainRamp, num);
+        smoothers[PAN_L].fill(outputGainL, num);
+        smoothers[PAN_R].fill(outputGainR, num);
+        FVO::multiply(outputGainL, gainRamp, num);
+        FVO::multiply(outputGainR, gainRamp, num);
+      }
+
+      UTILITY_CLONE_TRACE_SCOPE(isBassMono ? "bass mono" : "matrix");
+      for (int p = 0; p < groups.numPairs; ++p) {
+        const auto pair = groups.pairs[p];
+        auto* left = buffer.getWritePointer(pair.left, start);
+        auto* right = buffer.getWritePointer(pair.right, start);
+        if (isBassMono) {
+          dispatch(kernelFeatures, [&](auto features) {
+            processBassMono<features>(
+                left, right, pair, num,
+                [&](int i) { return Matrix::midSide(midScale[i], sideScale[i]) * routing; },
+                [&](int i) { return Matrix::diagonal(outputGainL[i], outputGainR[i]); });
+          });
+        } else {
+          kernels.applyMidSideRamp(left, right, num, routing, midScale, sideScale, outputGainL,
+                                   outputGainR);
+        }
+      }
+      for (int s = 0; s < groups.numSingles; ++s) {
+        auto* data = buffer.getWritePointer(groups.singles[s], start);
+        FVO::multiply(data, gainRamp, num);
+        if (singlePhase < zero) FVO::negate(data, data, num);
+        if (isBassMono && !isLinearPhase) lrFilter.processAllpass(groups.singles[s], data, num);
+      }
+    }
+  }
+
+  // What the Bass Mono loop does, fixed for a block. Every combination is compiled as its own
+  // kernel, so the loop itself has no branches; the slope is 24 dB/oct without a SLOPE bit.
+  enum KernelFeature {
+    LINEAR_PHASE = 1 << 0,
+    MONO_LOW = 1 << 1,  // Bass Mono on, not only listening
+    LISTENING = 1 << 2,
+    SLOPE_12 = 1 << 3,
+    SLOPE_48 = 1 << 4,
+    NUM_KERNELS = 1 << 5,
+  };
+
+  int getKernelFeatures(const ParameterSnapshot& params) const {
+    int features = params.isBassMono ? MONO_LOW : 0;
+    if (params.isBassMonoListening) features |= LISTENING;
+    if (isLinearPhase) return features | LINEAR_PHASE;
+    const int slope = lrFilter.getSlope();
+    return features | (slope == 12 ? SLOPE_12 : 0) | (slope == 48 ? SLOPE_48 : 0);
+  }
+
+  // Calls kernel(std::integral_constant<int, features>()) through a table with one entry per
+  // combination, built at compile time: one indirect call per block instead of the tests.
+  template <typename Kernel>
+  static void dispatch(int features, const Kernel& kernel) {
+    static constexpr auto table =
+        makeDispatchTable<Kernel>(std::make_integer_sequence<int, NUM_KERNELS>());
+    table[static_cast<size_t>(features)](kernel);
+  }
+
+  template <typename Kernel, int... features>
+  static constexpr auto makeDispatchTable(std::integer_sequence<int, features...>) {
+    return std::array<void (*)(const Kernel&), sizeof...(features)>{
+        [](const Kernel& kernel) { kernel(std::integral_constant<int, features>()); }...};
+  }
+
+  template <int features, typename PreMatrix, typename PostMatrix>
+  void processBassMono(SampleType* left, SampleType* right, ChannelGroups::Pair channels,
+                       int numSamples, const PreMatrix& pre, const PostMatrix& post) {
+    constexpr int slope = (features & SLOPE_12) ? 12 : ((features & SLOPE_48) ? 48 : 24);
+    for (int i = 0; i < numSamples; ++i) {
+      auto l = left[i];
+      auto r = right[i];
+      pre(i).apply(l, r);
+
+      SampleType lowL, lowR, highL, highR;
+      if constexpr ((features & LINEAR_PHASE) != 0) {
+        linearPhaseCrossover.processSample(channels, l, r, lowL, highL, lowR, highR);
+      } else {
+        lrFilter.template processSample<slope>(channels, i, l, r, lowL, highL, lowR, highR);
+      }
+
+      // make low output mono
+      if constexpr ((features & MONO_LOW) != 0)
+        lowL = lowR = (lowL + lowR) * static_cast<SampleType>(0.5);
+
+      if constexpr ((features & LISTENING) != 0) {
+        l = lowL;
+        r = lowR;
+      } else {
+        l = lowL + highL;
+        r = lowR + highR;
+      }
+      post(i).apply(l, r);
+
+      left[i] = l;
+      right[i] = r;
+    }
+  }
+
+  // the matrix, ramp and silence loops for this CPU, picked when the instance is created
+  const SimdKernels<SampleType>& kernels = *SimdKernels<SampleType>::get(detectSimdLevel());
+
+  LinkwitzRileyCrossover<SampleType> lrFilter;
+  LinearPhaseCrossover<SampleType> linearPhaseCrossover;
+  bool isLinearPhase = false;
+  StereoBiquad<SampleType> dcFilter;
+
+  // dry to processed fade after bypass()
+  bool isBypassed = false;
+  int fadeLength = 1;
+  int fadePosition = 1;  // fadeLength when not fading
+  juce::AudioBuffer<SampleType> dry;  // the faded part of the input
+
+  // All linear: the gain is a linear gain which can reach 0, so it cannot ramp multiplicatively.
+  enum SmoothedId {
+    WIDTH,
+    MID_SIDE,
+    GAIN,
+    PAN_L,  // sin3dB, centre = 1
+    PAN_R,
+    NUM_SMOOTHED,
+  };
+  SmoothedParameters<SampleType, NUM_SMOOTHED> smoothers;
+
+  // per-sample smoother ramps while a parameter is moving
+  enum ScratchSlot {
+    MID_SCALE,
+    SIDE_SCALE,
+    GAIN_RAMP,
+    OUTPUT_GAIN_L,
+    OUTPUT_GAIN_R,
+    NUM_SCRATCH_SLOTS,
+  };
+  ScratchArena<SampleType> scratch;
+};
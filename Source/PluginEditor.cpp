@@ -51,7 +51,9 @@ UtilityCloneAudioProcessorEditor::UtilityCloneAudioProcessorEditor(
     stereoWidthSlider.setAndUpdateDisabled(isMonoByChannelMode() || *isMono);
     stereoMidSideSlider.setAndUpdateDisabled(isMonoByChannelMode() || *isMono);
     bassMonoToggleButton.setAndUpdateDisabled(isMonoByChannelMode() || *isMono);
+    bassMonoLinearPhaseButton.setAndUpdateDisabled(isMonoByChannelMode() || *isMono);
     bassMonoFrequencySlider.setAndUpdateDisabled(isMonoByChannelMode() || *isMono || !*isBassMono);
+    bassMonoSlopeSlider.setAndUpdateDisabled(isMonoByChannelMode() || *isMono || !*isBassMono);
   };
   addAndMakeVisible(channelModeComboBox);
 
@@ -61,7 +63,9 @@ UtilityCloneAudioProcessorEditor::UtilityCloneAudioProcessorEditor(
     stereoWidthSlider.setAndUpdateDisabled(isMonoByChannelMode() || state);
     stereoMidSideSlider.setAndUpdateDisabled(isMonoByChannelMode() || state);
     bassMonoToggleButton.setAndUpdateDisabled(isMonoByChannelMode() || state);
+    bassMonoLinearPhaseButton.setAndUpdateDisabled(isMonoByChannelMode() || state);
     bassMonoFrequencySlider.setAndUpdateDisabled(isMonoByChannelMode() || state || !*isBassMono);
+    bassMonoSlopeSlider.setAndUpdateDisabled(isMonoByChannelMode() || state || !*isBassMono);
   };
   addAndMakeVisible(monoToggleButton);
 
@@ -101,6 +105,7 @@ UtilityCloneAudioProcessorEditor::UtilityCloneAudioProcessorEditor(
   bassMonoToggleButton.onClick = [this]() {
     auto state = bassMonoToggleButton.getToggleState();
     bassMonoFrequencySlider.setAndUpdateDisabled(*isMono || isMonoByChannelMode() || !state);
+    bassMonoSlopeSlider.setAndUpdateDisabled(*isMono || isMonoByChannelMode() || !state);
   };
   addAndMakeVisible(bassMonoToggleButton);
 
@@ -109,6 +114,20 @@ UtilityCloneAudioProcessorEditor::UtilityCloneAudioProcessorEditor(
   bassMonoFrequencySlider.setTextValueSuffix(" Hz");
   addAndMakeVisible(bassMonoFrequencySlider);
 
+  bassMonoSlopeSliderAttachment.reset(
+      new SliderAttachment(valueTreeState, "bassMonoSlope", bassMonoSlopeSlider));
+  // only the number fits, "24 dB/oct" is left to the host
+  bassMonoSlopeSlider.textFromValueFunction = [](double value) {
+    return juce::String(12 << juce::roundToInt(value));
+  };
+  bassMonoSlopeSlider.updateText();
+  addAndMakeVisible(bassMonoSlopeSlider);
+
+  // linear-phase crossover, at the cost of about 50 ms latency
+  bassMonoLinearPhaseButtonAttachment.reset(
+      new ButtonAttachment(valueTreeState, "isBassMonoLinearPhase", bassMonoLinearPhaseButton));
+  addAndMakeVisible(bassMonoLinearPhaseButton);
+
   bassMonoListeningButtonAttachment.reset(
       new ButtonAttachment(valueTreeState, "isBassMonoListening", bassMonoListeningButton));
   addAndMakeVisible(bassMonoListeningButton);
@@ -142,10 +161,19 @@ UtilityCloneAudioProcessorEditor::UtilityCloneAudioProcessorEditor(
   outputLabel.setJustificationType(juce::Justification::centred);
   addAndMakeVisible(outputLabel);
 
-  setSize(width, height);
+  addAndMakeVisible(inputMeter);
+  addAndMakeVisible(outputMeter);
+  addAndMakeVisible(loadDisplay);
+  // the processor only measures levels while an editor is open, the load always
+  audioProcessor.getLevelMeter().setActive(true);
+  startTimerHz(timerHz);
+
+  setSize(width, height + meterHeight + loadHeight);
 }
 
-UtilityCloneAudioProcessorEditor::~UtilityCloneAudioProcessorEditor() {}
+UtilityCloneAudioProcessorEditor::~UtilityCloneAudioProcessorEditor() {
+  audioProcessor.getLevelMeter().setActive(false);
+}
 
 //==============================================================================
 bool UtilityCloneAudioProcessorEditor::keyPressed(const juce::KeyPress& key) {
@@ -184,7 +212,7 @@ void UtilityCloneAudioProcessorEditor::paint(juce::Graphics& g) {
 
 void UtilityCloneAudioProcessorEditor::resized() {
   width = getWidth();
-  height = getHeight();
+  height = getHeight() - meterHeight - loadHeight;
 
   const int padding = 5;
   const int componentHeight = 22;
@@ -241,14 +269,24 @@ void UtilityCloneAudioProcessorEditor::resized() {
   monoToggleButton.setBounds(rect);
 
   rect.setTop(240);
+  rect.setWidth(rect.getWidth() - 34);
   rect.setHeight(componentHeight);
   bassMonoToggleButton.setBounds(rect);
 
+  rect.setX(rect.getRight() + 4);
+  rect.setWidth(30);
+  bassMonoLinearPhaseButton.setBounds(rect);
+
+  rect = columnL.reduced(padding);
   rect.setTop(270);
-  rect.setWidth(rect.getWidth() - 24);
+  rect.setWidth(rect.getWidth() - 24 - 26);
   rect.setHeight(20);
   bassMonoFrequencySlider.setBounds(rect);
 
+  rect.setX(rect.getRight() + 2);
+  rect.setWidth(22);
+  bassMonoSlopeSlider.setBounds(rect);
+
   rect = columnL.reduced(padding);
   rect.setTop(270);
   rect.setX(rect.getX() + rect.getWidth() - 20);
@@ -283,6 +321,31 @@ void UtilityCloneAudioProcessorEditor::resized() {
   rect.setHeight(componentHeight);
   rect.setWidth(30);
   dcToggleButton.setBounds(rect);
+
+  // meters
+  rect = columnL.reduced(padding, 0);
+  rect.setTop(height);
+  rect.setHeight(meterHeight - padding);
+  inputMeter.setBounds(rect);
+
+  rect = columnR.reduced(padding, 0);
+  rect.setTop(height);
+  rect.setHeight(meterHeight - padding);
+  outputMeter.setBounds(rect);
+
+  loadDisplay.setBounds(0, height + meterHeight - padding, width, loadHeight);
+}
+
+void UtilityCloneAudioProcessorEditor::timerCallback() {
+  LevelMeter::Reading reading;
+  if (audioProcessor.getLevelMeter().pop(reading)) {
+    inputMeter.update(reading.input);
+    outputMeter.update(reading.output);
+  } else {
+    inputMeter.decay();
+    outputMeter.decay();
+  }
+  loadDisplay.update(audioProcessor.getLoadMeter(), timerHz);
 }
 
 void UtilityCloneAudioProcessorEditor::updateStereoLabel() {
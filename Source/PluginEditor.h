@@ -20,6 +20,8 @@
 #include "UI/CustomLabel.h"
 #include "UI/KnobSlider.h"
 #include "UI/IconButton.h"
+#include "UI/LevelMeterDisplay.h"
+#include "UI/LoadDisplay.h"
 #include "UI/MiniTextSlider.h"
 #include "UI/ToggleTextButton.h"
 #include "UI/TogglePhaseButton.h"
@@ -27,7 +29,7 @@
 //==============================================================================
 /**
  */
-class UtilityCloneAudioProcessorEditor : public juce::AudioProcessorEditor {
+class UtilityCloneAudioProcessorEditor : public juce::AudioProcessorEditor, private juce::Timer {
  public:
   UtilityCloneAudioProcessorEditor(UtilityCloneAudioProcessor&,
                                    juce::AudioProcessorValueTreeState& vts, juce::UndoManager& um);
@@ -40,6 +42,7 @@ class UtilityCloneAudioProcessorEditor : public juce::AudioProcessorEditor {
   void resized() override;
 
  private:
+  void timerCallback() override;
   void updateStereoLabel();
   bool isMonoByChannelMode();
 
@@ -49,7 +52,10 @@ class UtilityCloneAudioProcessorEditor : public juce::AudioProcessorEditor {
   juce::UndoManager& undoManager;
 
   int width = 200;
-  int height = 300;
+  int height = 300;  // without the meters and the load
+  const int meterHeight = 24;
+  const int loadHeight = 14;
+  static constexpr int timerHz = 30;
   //   double ratio = width / height;
 
   // watch parameter for ui
@@ -82,6 +88,10 @@ class UtilityCloneAudioProcessorEditor : public juce::AudioProcessorEditor {
   MiniTextSlider bassMonoFrequencySlider{valueTreeState, "bassMonoFrequency", &customLookAndFeel,
                                          menu,
                                          *isMono != 0 || isMonoByChannelMode() || *isBassMono == 0};
+  MiniTextSlider bassMonoSlopeSlider{valueTreeState, "bassMonoSlope", &customLookAndFeel, menu,
+                                     *isMono != 0 || isMonoByChannelMode() || *isBassMono == 0};
+  ToggleTextButton bassMonoLinearPhaseButton{"Lin", &customLookAndFeel, menu,
+                                             *isMono != 0 || isMonoByChannelMode()};
   IconButton bassMonoListeningButton{
       juce::ImageCache::getFromMemory(BinaryData::headphone_16_16_png,
                                       BinaryData::headphone_16_16_pngSize),
@@ -99,6 +109,8 @@ class UtilityCloneAudioProcessorEditor : public juce::AudioProcessorEditor {
   std::unique_ptr<SliderAttachment> stereoMidSideSliderAttachment;
   std::unique_ptr<ButtonAttachment> bassMonoToggleButtonAttachment;
   std::unique_ptr<SliderAttachment> bassMonoFrequencySliderAttachment;
+  std::unique_ptr<SliderAttachment> bassMonoSlopeSliderAttachment;
+  std::unique_ptr<ButtonAttachment> bassMonoLinearPhaseButtonAttachment;
   std::unique_ptr<ButtonAttachment> bassMonoListeningButtonAttachment;
   std::unique_ptr<ButtonAttachment> dcToggleButtonAttachment;
 
@@ -110,6 +122,9 @@ class UtilityCloneAudioProcessorEditor : public juce::AudioProcessorEditor {
   CustomLabel gainLabel{menu};
   CustomLabel panLabel{menu};
   CustomLabel stereoModeLabel{menu};
+  LevelMeterDisplay inputMeter;
+  LevelMeterDisplay outputMeter;
+  LoadDisplay loadDisplay;
 
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(UtilityCloneAudioProcessorEditor)
 };
@@ -71,23 +71,36 @@ UtilityCloneAudioProcessor::UtilityCloneAudioProcessor()
               std::make_unique<juce::AudioParameterBool>("isBassMonoListening",
                                                          "Bass Mono Listening", false),
               std::make_unique<juce::AudioParameterBool>("isDc", "DC", false),
+              // appended, so hosts addressing parameters by index keep their automation
+              std::make_unique<juce::AudioParameterBool>("isBassMonoLinearPhase",
+                                                         "Bass Mono Linear Phase", false),
+              std::make_unique<juce::AudioParameterChoice>("bassMonoSlope", "Bass Mono Slope",
+                                                           bassMonoSlopeList, 1),
           }) {
-  gain = parameters.getRawParameterValue("gain");
-  isInvertPhaseL = parameters.getRawParameterValue("invertPhaseL");
-  isInvertPhaseR = parameters.getRawParameterValue("invertPhaseR");
-  channelMode = parameters.getRawParameterValue("channelMode");
-  isMono = parameters.getRawParameterValue("mono");
-  pan = parameters.getRawParameterValue("pan");
-  stereoMode = parameters.getRawParameterValue("stereoMode");
-  stereoWidth = parameters.getRawParameterValue("stereoWidth");
-  stereoMidSide = parameters.getRawParameterValue("stereoMidSide");
-  isBassMono = parameters.getRawParameterValue("isBassMono");
-  bassMonoFrequency = parameters.getRawParameterValue("bassMonoFrequency");
-  isBassMonoListening = parameters.getRawParameterValue("isBassMonoListening");
-  isDc = parameters.getRawParameterValue("isDc");
+  gain = getParameterValue("gain");
+  isInvertPhaseL = getParameterValue("invertPhaseL");
+  isInvertPhaseR = getParameterValue("invertPhaseR");
+  channelMode = getParameterValue("channelMode");
+  isMono = getParameterValue("mono");
+  pan = getParameterValue("pan");
+  stereoMode = getParameterValue("stereoMode");
+  stereoWidth = getParameterValue("stereoWidth");
+  stereoMidSide = getParameterValue("stereoMidSide");
+  isBassMono = getParameterValue("isBassMono");
+  bassMonoFrequency = getParameterValue("bassMonoFrequency");
+  isBassMonoListening = getParameterValue("isBassMonoListening");
+  isBassMonoLinearPhase = getParameterValue("isBassMonoLinearPhase");
+  bassMonoSlope = getParameterValue("bassMonoSlope");
+  isDc = getParameterValue("isDc");
+
+  parameters.addParameterListener("isBassMonoLinearPhase", this);
+  parameters.addParameterListener("bassMonoSlope", this);
 }
 
-UtilityCloneAudioProcessor::~UtilityCloneAudioProcessor() {}
+UtilityCloneAudioProcessor::~UtilityCloneAudioProcessor() {
+  parameters.removeParameterListener("isBassMonoLinearPhase", this);
+  parameters.removeParameterListener("bassMonoSlope", this);
+}
 
 //==============================================================================
 const juce::String UtilityCloneAudioProcessor::getName() const { return JucePlugin_Name; }
@@ -135,22 +148,57 @@ void UtilityCloneAudioProcessor::changeProgramName(int index, const juce::String
 //==============================================================================
 void UtilityCloneAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock) {
   spec.maximumBlockSize = samplesPerBlock;
-  spec.numChannels = 2;
+  spec.numChannels = static_cast<juce::uint32>(
+      juce::jmax(getTotalNumInputChannels(), getTotalNumOutputChannels()));
   spec.sampleRate = sampleRate;
+  channelGroups = ChannelGroups::fromLayout(getChannelLayoutOfBus(true, 0));
+
+  // the host may switch precision between prepareToPlay calls, so keep both engines ready
+  floatEngine.prepare(spec);
+  doubleEngine.prepare(spec);
+
+  loadLinearPhaseKernels();
+  const auto params = getParameterSnapshot();
+  floatEngine.snapToParameters(params);
+  doubleEngine.snapToParameters(params);
+
+  // both engines start out empty
+  numSilentSamples = maxSilentSamples;
+  numProcessedBlocks = 0;
+  numSkippedBlocks = 0;
+  numBypassedBlocks = 0;
+
+  levelMeter.prepare(sampleRate);
+  loadMeter.prepare(sampleRate);
+  updateLatency();
+}
 
-  width.reset(sampleRate, 0.001);
-  midSide.reset(sampleRate, 0.001);
-
-  lrFilter.prepare(spec);
+// Called on the audio thread too, for host automation, which must neither build kernels nor tell
+// the host of a new latency: both wait for the message thread.
+void UtilityCloneAudioProcessor::parameterChanged(const juce::String&, float) {
+  triggerAsyncUpdate();
+}
 
-  gainDSP.prepare(spec);
-  gainDSP.setRampDurationSeconds(0.005);  // should consider arguments or using SmoothValue
+void UtilityCloneAudioProcessor::handleAsyncUpdate() {
+  loadLinearPhaseKernels();
+  updateLatency();
+}
 
-  pannerDSP.prepare(spec);
-  pannerDSP.setRule(juce::dsp::PannerRule::sin3dB);
+// Only the selected slope's, and only while the linear-phase crossover is selected: the kernels
+// take a few MB per slope. Until they are there, the crossover keeps the previous slope's. For a
+// state restored before prepareToPlay the crossover has no rate yet and skips: prepareToPlay
+// loads them.
+void UtilityCloneAudioProcessor::loadLinearPhaseKernels() {
+  if (isBassMonoLinearPhase.raw->load() < 0.5f) return;
+  const int slope = getParameterSnapshot().bassMonoSlope;
+  floatEngine.loadLinearPhaseSlope(slope);
+  doubleEngine.loadLinearPhaseSlope(slope);
+}
 
-  *dcFilter.state = *juce::dsp::IIR::Coefficients<float>::makeHighPass(sampleRate, 5.0f);
-  dcFilter.prepare(spec);
+// the linear-phase crossover delays every channel, whether Bass Mono is on or not
+void UtilityCloneAudioProcessor::updateLatency() {
+  setLatencySamples(isBassMonoLinearPhase.raw->load() >= 0.5f ? floatEngine.getLinearPhaseLatency()
+                                                               : 0);
 }
 
 void UtilityCloneAudioProcessor::releaseResources() {
@@ -164,13 +212,10 @@ bool UtilityCloneAudioProcessor::isBusesLayoutSupported(const BusesLayout& layou
   juce::ignoreUnused(layouts);
   return true;
 #else
-  // This is the place where you check if the layout is supported.
-  // In this template code we only support mono or stereo.
-  // Some plugin hosts, such as certain GarageBand versions, will only
-  // load plugins that support stereo bus layouts.
-  if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono() &&
-      layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
-    return false;
+  // Any layout up to ChannelGroups::maxChannels: mono, stereo, surround, ambisonic or discrete.
+  // Left/right speaker pairs get the stereo controls, the other channels only phase and gain.
+  const auto& mainOutput = layouts.getMainOutputChannelSet();
+  if (mainOutput.isDisabled() || mainOutput.size() > ChannelGroups::maxChannels) return false;
 
     // This checks if the input layout matches the output layout
 #if !JucePlugin_IsSynth
@@ -184,126 +229,79 @@ bool UtilityCloneAudioProcessor::isBusesLayoutSupported(const BusesLayout& layou
 
 void UtilityCloneAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer,
                                               juce::MidiBuffer& midiMessages) {
+  const LoadMeter::ScopedTimer timer(loadMeter, buffer.getNumSamples());
+  process(buffer, floatEngine);
+}
+
+void UtilityCloneAudioProcessor::processBlock(juce::AudioBuffer<double>& buffer,
+                                              juce::MidiBuffer& midiMessages) {
+  const LoadMeter::ScopedTimer timer(loadMeter, buffer.getNumSamples());
+  process(buffer, doubleEngine);
+}
+
+bool UtilityCloneAudioProcessor::supportsDoublePrecisionProcessing() const { return true; }
+
+template <typename SampleType>
+void UtilityCloneAudioProcessor::process(juce::AudioBuffer<SampleType>& buffer,
+                                         UtilityEngine<SampleType>& engine) {
+  UTILITY_CLONE_TRACE_SCOPE("processBlock");
   juce::ScopedNoDenormals noDenormals;
   const int totalNumInputChannels = getTotalNumInputChannels();
   const int totalNumOutputChannels = getTotalNumOutputChannels();
   const int numSamples = buffer.getNumSamples();
 
-  // phase
-  auto phaseL = *isInvertPhaseL ? -1.0f : 1.0f;
-  auto phaseR = *isInvertPhaseR ? -1.0f : 1.0f;
-  buffer.applyGain(0, 0, numSamples, phaseL);
-  if (totalNumInputChannels == 2) buffer.applyGain(1, 0, numSamples, phaseR);
-
-  // channel mode
-  // DBG("channel mode: " << channelModeList[(int)*channelMode]);
-  if (totalNumInputChannels == 2) {
-    if (channelModeList[(int)*channelMode] == "Right") {
-      buffer.clear(0, 0, numSamples);
-      buffer.copyFrom(0, 0, buffer, 1, 0, buffer.getNumSamples());
-    } else if (channelModeList[(int)*channelMode] == "Left") {
-      buffer.clear(1, 0, numSamples);
-      buffer.copyFrom(1, 0, buffer, 0, 0, buffer.getNumSamples());
-    } else if (channelModeList[(int)*channelMode] == "Swap") {
-      juce::AudioBuffer<float> newBuffer;
-      newBuffer.makeCopyOf(buffer);
-      buffer.copyFrom(0, 0, newBuffer, 1, 0, newBuffer.getNumSamples());
-      buffer.copyFrom(1, 0, newBuffer, 0, 0, newBuffer.getNumSamples());
-    }
-  }
+  for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
+    buffer.clear(i, 0, numSamples);
 
-  // stereo
-  // DBG("stereoMode: " << *stereoMode);
-  width.setTargetValue(*stereoWidth);
-  midSide.setTargetValue(*stereoMidSide);
-  if (totalNumInputChannels == 2 && !*isMono && !isMonoByChannelMode()) {
-    auto* leftChannel = buffer.getWritePointer(0);
-    auto* rightChannel = buffer.getWritePointer(1);
-
-    for (int i = 0; i < buffer.getNumSamples(); ++i) {
-      auto mid = (rightChannel[i] + leftChannel[i]);
-      auto side = (rightChannel[i] - leftChannel[i]);
-
-      if (stereoModeList[(int)*stereoMode] == "Width") {  // Width (0 to 400)
-        side *= width.getNextValue() / 100;
-      } else {                                                   // Mid/Side (-100 to 100)
-        float scale = 1.0f - abs(midSide.getNextValue() / 100);  // 1 to 0
-        if (midSide.getNextValue() > 0) {
-          mid *= scale;
-        } else if (midSide.getNextValue() < 0) {
-          side *= scale;
-        }
-      }
-
-      leftChannel[i] = (mid - side) / 2.0f;
-      rightChannel[i] = (mid + side) / 2.0f;
-    }
+  const bool isMetering = levelMeter.isActive();
+  if (isMetering) {
+    UTILITY_CLONE_TRACE_SCOPE("input meter");
+    levelMeter.measureInput(buffer, channelGroups);
   }
 
-  // mono
-  if (*isMono && !isMonoByChannelMode()) {
-    // cf. https://forum.juce.com/t/how-do-i-sum-stereo-to-mono/37579/8
-    buffer.addFrom(0, 0, buffer, 1, 0, buffer.getNumSamples());
-    buffer.copyFrom(1, 0, buffer, 0, 0, buffer.getNumSamples());
-    buffer.applyGain(0.5f);
+  // Neutral settings: the buffer already holds the output.
+  const auto blockParams = getParameterSnapshot();
+  if (parameterChanges.isEmpty() &&
+      engine.bypass(blockParams, ProcessingPlan::build(blockParams, channelGroups,
+                                                        engine.getRamps(blockParams)))) {
+    numBypassedBlocks.fetch_add(1, std::memory_order_relaxed);
+    if (isMetering) levelMeter.measureOutput(buffer, channelGroups);
+    return;
   }
 
-  // bass mono
-  // DBG("Bass Mono = " << *isBassMono);
-  // DBG("BM Freq   = " << *bassMonoFrequency);
-  // DBG("BM L = " << *isBassMonoListening);
-  lrFilter.setCutoffFrequency(*bassMonoFrequency);
-  if (((*isBassMono && !*isMono) || *isBassMonoListening) && !isMonoByChannelMode()) {
-    juce::AudioSampleBuffer lowOutput;
-    juce::AudioSampleBuffer highOutput;
-
-    lowOutput.makeCopyOf(buffer);
-    highOutput.makeCopyOf(buffer);
-
-    auto* lowOutputL = lowOutput.getWritePointer(0);
-    auto* lowOutputR = lowOutput.getWritePointer(1);
-    auto* highOutputL = highOutput.getWritePointer(0);
-    auto* highOutputR = highOutput.getWritePointer(1);
-
-    auto* inputL = buffer.getWritePointer(0);
-    auto* inputR = buffer.getWritePointer(1);
-
-    // process filter
-    for (int i = 0; i < numSamples; ++i) {
-      lrFilter.processSample(0, inputL[i], lowOutputL[i], highOutputL[i]);
-      lrFilter.processSample(1, inputR[i], lowOutputR[i], highOutputR[i]);
+  // Silence in, and nothing left ringing in the filters: the buffer already holds the output.
+  // Queued changes all land at once, which nobody can hear in a silent block.
+  const bool isSilent = engine.isSilent(buffer, channelGroups);
+  if (isSilent) {
+    parameterChanges.applyAll();
+    const auto params = getParameterSnapshot(&parameterChanges);
+    const auto plan = ProcessingPlan::build(params, channelGroups, engine.getRamps(params));
+    if (engine.isDecayed(numSilentSamples, params, plan)) {
+      engine.skip(numSamples, params, plan);
+      numSkippedBlocks.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      engine.process(buffer, 0, numSamples, channelGroups, params, plan);
+      numProcessedBlocks.fetch_add(1, std::memory_order_relaxed);
     }
-
-    // make lowOutput mono
-    if (*isBassMono) {
-      lowOutput.addFrom(0, 0, lowOutput, 1, 0, numSamples);
-      lowOutput.copyFrom(1, 0, lowOutput, 0, 0, numSamples);
-      lowOutput.applyGain(0.5f);
-    }
-
-    buffer.clear();
-    for (int channel = 0; channel < totalNumInputChannels; channel++) {
-      buffer.addFrom(channel, 0, lowOutput, channel, 0, numSamples);
-      if (!*isBassMonoListening) {
-        buffer.addFrom(channel, 0, highOutput, channel, 0, numSamples);
-      }
+    parameterChanges.endBlock();
+  } else {
+    // Read every parameter once per segment, then run only the stages which are active. Without
+    // queued changes the whole block is one segment.
+    for (int start = 0; start < numSamples;) {
+      const int end = parameterChanges.beginSegment(start, numSamples);
+      const auto params = getParameterSnapshot(&parameterChanges);
+      const auto plan = ProcessingPlan::build(params, channelGroups, engine.getRamps(params));
+      engine.process(buffer, start, end - start, channelGroups, params, plan);
+      start = end;
     }
+    parameterChanges.endBlock();
+    numProcessedBlocks.fetch_add(1, std::memory_order_relaxed);
   }
+  numSilentSamples = isSilent ? juce::jmin(numSilentSamples + numSamples, maxSilentSamples) : 0;
 
-  juce::dsp::AudioBlock<float> audioBlock(buffer);
-  juce::dsp::ProcessContextReplacing<float> context(audioBlock);
-
-  for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
-    buffer.clear(i, 0, buffer.getNumSamples());
-
-  gainDSP.setGainDecibels(*gain);
-  pannerDSP.setPan(*pan / 50.0f);
-
-  gainDSP.process(context);
-  pannerDSP.process(context);
-
-  if (*isDc) {
-    dcFilter.process(context);
+  if (isMetering) {
+    UTILITY_CLONE_TRACE_SCOPE("output meter");
+    levelMeter.measureOutput(buffer, channelGroups);
   }
 }
 
@@ -318,12 +316,17 @@ juce::AudioProcessorEditor* UtilityCloneAudioProcessor::createEditor() {
 
 //==============================================================================
 void UtilityCloneAudioProcessor::getStateInformation(juce::MemoryBlock& destData) {
-  auto state = parameters.copyState();
-  std::unique_ptr<juce::XmlElement> xml(state.createXml());
-  copyXmlToBinary(*xml, destData);
+  binaryState.write(destData);
 }
 
 void UtilityCloneAudioProcessor::setStateInformation(const void* data, int sizeInBytes) {
+  // as replaceState() does, a loaded state cannot be undone
+  if (binaryState.read(data, sizeInBytes)) {
+    undoManager.clearUndoHistory();
+    return;
+  }
+
+  // sessions saved before the binary format: the parameter tree as XML
   std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
 
   if (xmlState.get() != nullptr)
@@ -337,7 +340,35 @@ juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter() {
   return new UtilityCloneAudioProcessor();
 }
 
-bool UtilityCloneAudioProcessor::isMonoByChannelMode() {
-  return channelModeList[(int)*channelMode] == "Right" ||
-         channelModeList[(int)*channelMode] == "Left";
+UtilityCloneAudioProcessor::ParameterValue UtilityCloneAudioProcessor::getParameterValue(
+    const juce::String& parameterID) {
+  return {parameters.getRawParameterValue(parameterID), parameters.getParameter(parameterID)};
+}
+
+ParameterSnapshot UtilityCloneAudioProcessor::getParameterSnapshot(
+    const ParameterChangeQueue* changes) const {
+  const auto load = [changes](const ParameterValue& value) {
+    float normalised;
+    if (changes != nullptr && changes->getValue(value.parameter->getParameterIndex(), normalised))
+      return value.parameter->convertFrom0to1(normalised);
+    return value.raw->load();
+  };
+
+  ParameterSnapshot params;
+  params.gain = load(gain);
+  params.isInvertPhaseL = load(isInvertPhaseL) >= 0.5f;
+  params.isInvertPhaseR = load(isInvertPhaseR) >= 0.5f;
+  params.channelMode = static_cast<ChannelMode>(static_cast<int>(load(channelMode)));
+  params.isMono = load(isMono) >= 0.5f;
+  params.pan = load(pan);
+  params.stereoMode = static_cast<StereoMode>(static_cast<int>(load(stereoMode)));
+  params.stereoWidth = load(stereoWidth);
+  params.stereoMidSide = load(stereoMidSide);
+  params.isBassMono = load(isBassMono) >= 0.5f;
+  params.bassMonoFrequency = load(bassMonoFrequency);
+  params.isBassMonoListening = load(isBassMonoListening) >= 0.5f;
+  params.isBassMonoLinearPhase = load(isBassMonoLinearPhase) >= 0.5f;
+  params.bassMonoSlope = 12 << static_cast<int>(load(bassMonoSlope));  // 12, 24, 48
+  params.isDc = load(isDc) >= 0.5f;
+  return params;
 }
@@ -11,10 +11,19 @@
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_dsp/juce_dsp.h>
 
+#include "BinaryState.h"
+#include "DSP/LevelMeter.h"
+#include "DSP/LoadMeter.h"
+#include "DSP/ParameterChangeQueue.h"
+#include "DSP/ProcessingPlan.h"
+#include "DSP/UtilityEngine.h"
+
 //==============================================================================
 /**
  */
-class UtilityCloneAudioProcessor : public juce::AudioProcessor {
+class UtilityCloneAudioProcessor : public juce::AudioProcessor,
+                                   private juce::AudioProcessorValueTreeState::Listener,
+                                   private juce::AsyncUpdater {
  public:
   //==============================================================================
   UtilityCloneAudioProcessor();
@@ -29,6 +38,8 @@ class UtilityCloneAudioProcessor : public juce::AudioProcessor {
 #endif
 
   void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+  void processBlock(juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+  bool supportsDoublePrecisionProcessing() const override;
 
   //==============================================================================
   juce::AudioProcessorEditor* createEditor() override;
@@ -53,35 +64,75 @@ class UtilityCloneAudioProcessor : public juce::AudioProcessor {
   void getStateInformation(juce::MemoryBlock& destData) override;
   void setStateInformation(const void* data, int sizeInBytes) override;
 
+  LevelMeter& getLevelMeter() { return levelMeter; }
+  // processBlock time against the real-time budget, see LoadMeter
+  const LoadMeter& getLoadMeter() const { return loadMeter; }
+  // sample-accurate changes for the next processBlock, see ParameterChangeQueue; the caller sets
+  // the parameters to their last values after it
+  ParameterChangeQueue& getParameterChangeQueue() { return parameterChanges; }
+  // The work left to the message thread (the linear-phase kernels of a new slope), done now by a
+  // caller without a message loop, like the command line tools between two blocks.
+  void handlePendingUpdates() { handleUpdateNowIfNeeded(); }
+
+  // Blocks since prepareToPlay, any thread. Skipped ones were silent in and out, bypassed ones
+  // had neutral settings (see process()).
+  struct BlockCounts {
+    juce::uint64 processed = 0, skipped = 0, bypassed = 0;
+  };
+  BlockCounts getBlockCounts() const {
+    return {numProcessedBlocks.load(std::memory_order_relaxed),
+            numSkippedBlocks.load(std::memory_order_relaxed),
+            numBypassedBlocks.load(std::memory_order_relaxed)};
+  }
+
  private:
-  bool isMonoByChannelMode();
+  void parameterChanged(const juce::String& parameterID, float newValue) override;
+  void handleAsyncUpdate() override;
+  void updateLatency();
+  void loadLinearPhaseKernels();
+  // a parameter as the snapshot reads it
+  struct ParameterValue {
+    std::atomic<float>* raw = nullptr;
+    juce::RangedAudioParameter* parameter = nullptr;
+  };
+  ParameterValue getParameterValue(const juce::String& parameterID);
+  // with changes, the values they queue for the current segment replace the raw ones
+  ParameterSnapshot getParameterSnapshot(const ParameterChangeQueue* changes = nullptr) const;
+  template <typename SampleType>
+  void process(juce::AudioBuffer<SampleType>& buffer, UtilityEngine<SampleType>& engine);
 
   juce::AudioProcessorValueTreeState parameters;
   juce::UndoManager undoManager;
+  BinaryState binaryState{parameters};
 
   juce::dsp::ProcessSpec spec;
-  juce::dsp::Gain<float> gainDSP;
-  juce::dsp::Panner<float> pannerDSP;
-  juce::dsp::LinkwitzRileyFilter<float> lrFilter;
-  juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, juce::dsp::IIR::Coefficients<float>>
-      dcFilter;
-
-  std::atomic<float>* gain = nullptr;
-  std::atomic<float>* isInvertPhaseL = nullptr;
-  std::atomic<float>* isInvertPhaseR = nullptr;
-  std::atomic<float>* channelMode = nullptr;
-  std::atomic<float>* isMono = nullptr;
-  std::atomic<float>* pan = nullptr;
-  std::atomic<float>* stereoMode = nullptr;  // Width or Mid/Side
-  std::atomic<float>* stereoWidth = nullptr;
-  std::atomic<float>* stereoMidSide = nullptr;
-  std::atomic<float>* isBassMono = nullptr;
-  std::atomic<float>* bassMonoFrequency = nullptr;
-  std::atomic<float>* isBassMonoListening = nullptr;
-  std::atomic<float>* isDc = nullptr;
-
-  juce::LinearSmoothedValue<float> width;
-  juce::LinearSmoothedValue<float> midSide;
+  ChannelGroups channelGroups;  // of the main input bus, updated in prepareToPlay
+  UtilityEngine<float> floatEngine;
+  UtilityEngine<double> doubleEngine;
+  LevelMeter levelMeter;
+  LoadMeter loadMeter;
+  ParameterChangeQueue parameterChanges;
+
+  // consecutive silent input samples up to the current block, for UtilityEngine::isDecayed()
+  static constexpr int maxSilentSamples = 1 << 30;
+  int numSilentSamples = maxSilentSamples;
+  std::atomic<juce::uint64> numProcessedBlocks{0}, numSkippedBlocks{0}, numBypassedBlocks{0};
+
+  ParameterValue gain;
+  ParameterValue isInvertPhaseL;
+  ParameterValue isInvertPhaseR;
+  ParameterValue channelMode;
+  ParameterValue isMono;
+  ParameterValue pan;
+  ParameterValue stereoMode;  // Width or Mid/Side
+  ParameterValue stereoWidth;
+  ParameterValue stereoMidSide;
+  ParameterValue isBassMono;
+  ParameterValue bassMonoFrequency;
+  ParameterValue isBassMonoListening;
+  ParameterValue isBassMonoLinearPhase;
+  ParameterValue bassMonoSlope;
+  ParameterValue isDc;
 
   //==============================================================================
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(UtilityCloneAudioProcessor)
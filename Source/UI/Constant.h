@@ -15,3 +15,4 @@ const std::unordered_map<std::string, juce::Colour> themeColours = {
 
 const auto stereoModeList = juce::StringArray("Width", "Mid/Side");
 const auto channelModeList = juce::StringArray("Left", "Stereo", "Right", "Swap");
+const auto bassMonoSlopeList = juce::StringArray("12 dB/oct", "24 dB/oct", "48 dB/oct");
@@ -0,0 +1,72 @@
+#pragma once
+
+// Two level bars (L, R: RMS filled, peak as a line) over a correlation track (-1 to +1).
+// The editor feeds it from its timer; peaks fall back at about 20 dB per second.
+class LevelMeterDisplay : public juce::Component {
+ public:
+  LevelMeterDisplay() { setInterceptsMouseClicks(false, false); }
+
+  void update(const LevelMeter::Levels& levels) {
+    peakL = juce::jmax(levels.peakL, peakL * peakDecay);
+    peakR = juce::jmax(levels.peakR, peakR * peakDecay);
+    rmsL = levels.getRmsL();
+    rmsR = levels.getRmsR();
+    correlation = levels.getCorrelation();
+    repaint();
+  }
+
+  void decay() {
+    if (peakL < silence && peakR < silence && rmsL == 0 && rmsR == 0) return;
+    update({});
+  }
+
+  void paint(juce::Graphics& g) override {
+    const auto barHeight = (getHeight() - 4) / 3;
+    auto bounds = getLocalBounds();
+    paintBar(g, bounds.removeFromTop(barHeight), rmsL, peakL);
+    bounds.removeFromTop(1);
+    paintBar(g, bounds.removeFromTop(barHeight), rmsR, peakR);
+    bounds.removeFromTop(2);
+    paintCorrelation(g, bounds);
+  }
+
+ private:
+  static constexpr float minDecibels = -60.0f;
+  static constexpr float maxDecibels = 6.0f;
+  static constexpr float peakDecay = 0.794f;  // -2 dB per 30 Hz tick
+  static constexpr float silence = 0.001f;    // -60 dB
+
+  static float toProportion(float gain) {
+    const auto decibels = juce::Decibels::gainToDecibels(gain, minDecibels);
+    return juce::jmap(decibels, minDecibels, maxDecibels, 0.0f, 1.0f);
+  }
+
+  static void paintBar(juce::Graphics& g, juce::Rectangle<int> bar, float rms, float peak) {
+    g.setColour(themeColours.at("lightblack"));
+    g.fillRect(bar);
+
+    g.setColour(themeColours.at("blue"));
+    g.fillRect(bar.withWidth(juce::roundToInt(bar.getWidth() * toProportion(rms))));
+
+    const auto peakX = bar.getX() + juce::roundToInt((bar.getWidth() - 1) * toProportion(peak));
+    g.setColour(peak >= 1.0f ? themeColours.at("orange") : themeColours.at("white"));
+    g.fillRect(peakX, bar.getY(), 1, bar.getHeight());
+  }
+
+  void paintCorrelation(juce::Graphics& g, juce::Rectangle<int> track) const {
+    g.setColour(themeColours.at("lightblack"));
+    g.fillRect(track);
+
+    const auto centreX = track.getCentreX();
+    g.setColour(themeColours.at("disabled"));
+    g.fillRect(centreX, track.getY(), 1, track.getHeight());
+
+    const auto x = centreX + juce::roundToInt(correlation * (track.getWidth() / 2 - 1));
+    g.setColour(correlation < 0 ? themeColours.at("orange") : themeColours.at("lightblue"));
+    g.fillRect(juce::jmin(x, centreX), track.getY(), std::abs(x - centreX) + 1, track.getHeight());
+  }
+
+  float peakL = 0, peakR = 0, rmsL = 0, rmsR = 0, correlation = 0;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LevelMeterDisplay)
+};
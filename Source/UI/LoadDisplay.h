@@ -0,0 +1,56 @@
+#pragma once
+
+// The processBlock load of this instance over the last few seconds: the median and the 99th
+// percentile block, in percent of the real-time budget. The editor calls update() from its
+// timer; a snapshot of the processor's histogram is taken once a second and the text shows the
+// difference to the one taken windowSeconds earlier.
+class LoadDisplay : public juce::Component {
+ public:
+  static constexpr int windowSeconds = 5;
+
+  LoadDisplay() { setInterceptsMouseClicks(false, false); }
+
+  void update(const LoadMeter& meter, int timerHz) {
+    if (!isPrimed) {  // blocks from before the editor opened are not shown
+      snapshots.fill(meter.getHistogram());
+      isPrimed = true;
+    }
+    if (++numTicks < timerHz) return;
+    numTicks = 0;
+
+    snapshots[newest] = meter.getHistogram();
+    const auto oldest = (newest + 1) % snapshots.size();
+    const auto window = LoadMeter::getDifference(snapshots[newest], snapshots[oldest]);
+    newest = oldest;
+
+    const auto text = LoadMeter::getNumBlocks(window) == 0
+                          ? juce::String("CPU -")
+                          : "CPU p50 " + format(LoadMeter::getPercentile(window, 0.5)) +
+                                "  p99 " + format(LoadMeter::getPercentile(window, 0.99));
+    if (text != label) {
+      label = text;
+      repaint();
+    }
+  }
+
+  void paint(juce::Graphics& g) override {
+    g.setColour(themeColours.at("disabled"));
+    g.setFont(11.0f);
+    g.drawText(label, getLocalBounds(), juce::Justification::centred, false);
+  }
+
+ private:
+  static juce::String format(double load) {
+    const auto percent = load * 100.0;
+    if (percent < 0.01) return "<0.01%";
+    return juce::String(percent, percent < 10.0 ? 2 : 0) + "%";
+  }
+
+  std::array<LoadMeter::Histogram, windowSeconds + 1> snapshots{};
+  bool isPrimed = false;
+  size_t newest = 0;
+  int numTicks = 0;
+  juce::String label{"CPU -"};
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LoadDisplay)
+};
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <algorithm>
+
+// Command line of utility-clone-benchmark.
+struct BenchmarkOptions {
+  static constexpr const char* usage =
+      "usage: utility-clone-benchmark [options]\n"
+      "\n"
+      "Times processBlock for every feature combination, block size and sample rate and prints\n"
+      "the results as JSON. Build in Release for meaningful numbers.\n"
+      "\n"
+      "  --block-sizes <n,...>   default 16,32,64,128,256,512,1024,2048,4096\n"
+      "  --sample-rates <n,...>  default 44100,48000,88200,96000,176400,192000\n"
+      "  --samples <n>           sample frames per measurement (default 131072)\n"
+      "  --repeats <n>           measurements per result, the median is reported (default 5)\n"
+      "  --filter <text>         only cases whose name contains the text, e.g. bassMono=on\n"
+      "  --automate <id>         sweep a parameter over its range, one new value per block,\n"
+      "                          e.g. bassMonoFrequency\n"
+      "  --silence               process digital silence instead of noise, e.g. to see the\n"
+      "                          blocks skipped once the filters have rung out\n"
+      "  --double                process in double precision\n"
+      "  --state                 time saving and loading the plugin state instead, per instance\n"
+      "                          of a 400 instance session (binary, and the former XML)\n"
+      "  --gate                  time the fixed workloads of the performance gate instead: a few\n"
+      "                          processBlock cases at 48 kHz / 512, the state, and creating\n"
+      "                          an instance, also as multiples of a calibration loop\n"
+      "  --baseline <file>       run --gate and compare with the JSON of an earlier --gate run,\n"
+      "                          by the multiples, so it may come from another machine; exits\n"
+      "                          with 1 when a workload got slower than the threshold, and with\n"
+      "                          2 when the file is missing\n"
+      "  --threshold <percent>   slowdown a workload may have against the baseline (default 10)\n"
+      "  --report <file>         write the comparison with the baseline to a file as well\n"
+      "  -o, --output <file>     write the JSON to a file instead of stdout\n";
+
+  juce::Array<int> blockSizes{16, 32, 64, 128, 256, 512, 1024, 2048, 4096};
+  juce::Array<double> sampleRates{44100, 48000, 88200, 96000, 176400, 192000};
+  int numSamples = 131072;
+  int numRepeats = 5;
+  juce::String filter;
+  juce::String automatedParameter;  // none when empty
+  bool isSilence = false;
+  bool isDoublePrecision = false;
+  bool isState = false;
+  bool isGate = false;
+  juce::File baselineFile;  // no comparison when not set
+  double thresholdPercent = 10;
+  juce::File reportFile;  // stdout only when not set
+  juce::File outputFile;  // stdout when not set
+
+  static juce::Result parse(const juce::StringArray& args, BenchmarkOptions& options) {
+    for (int i = 0; i < args.size(); ++i) {
+      const auto& arg = args[i];
+      const auto nextValue = [&]() -> juce::String { return ++i < args.size() ? args[i] : ""; };
+
+      if (arg == "--block-sizes") {
+        options.blockSizes.clear();
+        for (const auto& value : split(nextValue())) options.blockSizes.add(value.getIntValue());
+      } else if (arg == "--sample-rates") {
+        options.sampleRates.clear();
+        for (const auto& value : split(nextValue()))
+          options.sampleRates.add(value.getDoubleValue());
+      } else if (arg == "--samples") {
+        options.numSamples = nextValue().getIntValue();
+      } else if (arg == "--repeats") {
+        options.numRepeats = nextValue().getIntValue();
+      } else if (arg == "--filter") {
+        options.filter = nextValue();
+      } else if (arg == "--automate") {
+        options.automatedParameter = nextValue();
+      } else if (arg == "--silence") {
+        options.isSilence = true;
+      } else if (arg == "--double") {
+        options.isDoublePrecision = true;
+      } else if (arg == "--state") {
+        options.isState = true;
+      } else if (arg == "--gate") {
+        options.isGate = true;
+      } else if (arg == "--baseline") {
+        options.isGate = true;
+        options.baselineFile = juce::File::getCurrentWorkingDirectory().getChildFile(nextValue());
+      } else if (arg == "--threshold") {
+        options.thresholdPercent = nextValue().getDoubleValue();
+      } else if (arg == "--report") {
+        options.reportFile = juce::File::getCurrentWorkingDirectory().getChildFile(nextValue());
+      } else if (arg == "-o" || arg == "--output") {
+        options.outputFile = juce::File::getCurrentWorkingDirectory().getChildFile(nextValue());
+      } else {
+        return juce::Result::fail("unknown option " + arg);
+      }
+    }
+
+    const auto isPositive = [](const auto& values) {
+      return !values.isEmpty() && std::all_of(values.begin(), values.end(),
+                                              [](auto value) { return value > 0; });
+    };
+    if (!isPositive(options.blockSizes))
+      return juce::Result::fail("--block-sizes must be positive");
+    if (!isPositive(options.sampleRates))
+      return juce::Result::fail("--sample-rates must be positive");
+    if (options.numSamples <= 0) return juce::Result::fail("--samples must be positive");
+    if (options.numRepeats <= 0) return juce::Result::fail("--repeats must be positive");
+    if (options.thresholdPercent <= 0) return juce::Result::fail("--threshold must be positive");
+    if (options.isGate && options.isState)
+      return juce::Result::fail("--state and --gate are separate runs");
+    if (options.baselineFile != juce::File() && !options.baselineFile.existsAsFile())
+      return juce::Result::fail("baseline not found: " + options.baselineFile.getFullPathName());
+    if (options.reportFile != juce::File() && options.baselineFile == juce::File())
+      return juce::Result::fail("--report needs a --baseline to compare with");
+
+    return juce::Result::ok();
+  }
+
+ private:
+  static juce::StringArray split(const juce::String& list) {
+    return juce::StringArray::fromTokens(list, ",", "");
+  }
+};
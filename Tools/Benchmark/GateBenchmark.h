@@ -0,0 +1,224 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "FeatureCases.h"
+#include "ProcessBlockBenchmark.h"
+#include "StateBenchmark.h"
+
+// The fixed workloads of the performance gate: processBlock for a few feature cases at 48 kHz
+// and 512 samples, saving and loading the state, and creating an instance. Every time is a
+// median, and is also kept as a multiple of the time of a fixed calibration loop measured in the
+// same run. That ratio cancels most of the clock and the machine, so a run can be compared with
+// the JSON of an earlier run made elsewhere, e.g. on another CI runner (compare()).
+class GateBenchmark {
+ public:
+  struct Workload {
+    juce::String name;
+    juce::String unit;
+    double median = 0;
+    double relative = 0;  // median / calibration ns per sample
+  };
+
+  static juce::Result measure(int numSamples, int numRepeats, double& calibration,
+                              juce::Array<Workload>& results) {
+    calibration = timeCalibration(numSamples, numRepeats);
+    for (const auto& workload : processBlockWorkloads) {
+      UtilityCloneAudioProcessor processor;
+      processor.setProcessingPrecision(workload.isDouble ? juce::AudioProcessor::doublePrecision
+                                                         : juce::AudioProcessor::singlePrecision);
+      auto result = workload.featureCase.apply(processor);
+      if (result.failed()) return result;
+
+      juce::AudioProcessorParameter* automated = nullptr;
+      if (workload.automated != nullptr) {
+        automated = findParameter(processor, workload.automated);
+        if (automated == nullptr)
+          return juce::Result::fail("unknown parameter " + juce::String(workload.automated));
+      }
+
+      const auto measurement =
+          workload.isDouble
+              ? ProcessBlockBenchmark::measure<double>(processor, sampleRate, blockSize,
+                                                       numSamples, numRepeats, false, automated)
+              : ProcessBlockBenchmark::measure<float>(processor, sampleRate, blockSize,
+                                                      numSamples, numRepeats, false, automated);
+      results.add({juce::String("processBlock ") + workload.name, "ns/sample",
+                   measurement.nsPerSampleMedian, measurement.nsPerSampleMedian / calibration});
+    }
+
+    {
+      UtilityCloneAudioProcessor processor;
+      juce::Array<StateBenchmark::Measurement> measurements;
+      const auto result = StateBenchmark::measure(processor, numRepeats, measurements);
+      if (result.failed()) return result;
+      for (const auto& measurement : measurements) {
+        if (measurement.saveNsMedian > 0)
+          results.add({"state save " + measurement.format, "ns/call", measurement.saveNsMedian,
+                       measurement.saveNsMedian / calibration});
+        results.add({"state load " + measurement.format, "ns/call", measurement.loadNsMedian,
+                     measurement.loadNsMedian / calibration});
+      }
+    }
+
+    const auto construction = timeConstruction(numRepeats);
+    results.add({"construct and destroy", "ns/instance", construction, construction / calibration});
+    return juce::Result::ok();
+  }
+
+  static juce::var toJson(const juce::Array<Workload>& workloads) {
+    juce::Array<juce::var> results;
+    for (const auto& workload : workloads) {
+      auto* result = new juce::DynamicObject();
+      result->setProperty("name", workload.name);
+      result->setProperty("unit", workload.unit);
+      result->setProperty("median", workload.median);
+      result->setProperty("relative", workload.relative);
+      results.add(result);
+    }
+    return results;
+  }
+
+  // A table of every workload against the baseline (the JSON of a --gate run), by the multiples of
+  // the calibration loop; returns how many got slower by more than threshold (0.1 for 10%).
+  // Workloads new since the baseline, or gone from it, are listed but do not count.
+  static int compare(const juce::Array<Workload>& workloads, const juce::var& baseline,
+                     double threshold, juce::String& report) {
+    const auto* baselineResults = baseline["results"].getArray();
+    const auto findBaseline = [&](const juce::String& name) -> const juce::var* {
+      if (baselineResults == nullptr) return nullptr;
+      for (const auto& result : *baselineResults)
+        if (result["name"].toString() == name) return &result;
+      return nullptr;
+    };
+
+    report << "threshold +" << juce::String(threshold * 100.0, 1)
+           << "%, times in multiples of the calibration loop\n";
+    const auto baselineCpu = baseline["system"]["cpu"].toString();
+    if (baselineCpu != juce::SystemStats::getCpuModel())
+      report << "the baseline was measured on " << baselineCpu
+             << ", another microarchitecture may shift the ratios\n";
+    report << "\n"
+           << juce::String("workload").paddedRight(' ', nameWidth) << column("baseline")
+           << column("now") << column("change") << "  unit\n";
+
+    int numRegressions = 0;
+    for (const auto& workload : workloads) {
+      report << workload.name.paddedRight(' ', nameWidth);
+      const auto* previous = findBaseline(workload.name);
+      const auto previousRelative =
+          previous != nullptr ? static_cast<double>((*previous)["relative"]) : 0.0;
+      if (previousRelative <= 0) {
+        report << column("-") << column(format(workload.relative)) << column("new") << "  "
+               << workload.unit << "\n";
+        continue;
+      }
+
+      const auto change = workload.relative / previousRelative - 1.0;
+      const bool isRegression = change > threshold;
+      if (isRegression) ++numRegressions;
+      report << column(format(previousRelative)) << column(format(workload.relative))
+             << column((change >= 0 ? "+" : "") + juce::String(change * 100.0, 1) + "%") << "  "
+             << workload.unit << (isRegression ? "  SLOWER" : "") << "\n";
+    }
+
+    if (baselineResults != nullptr) {
+      for (const auto& result : *baselineResults) {
+        const auto name = result["name"].toString();
+        const bool isMeasured = std::any_of(workloads.begin(), workloads.end(),
+                                            [&](const auto& w) { return w.name == name; });
+        if (!isMeasured) report << name.paddedRight(' ', nameWidth) << column("gone") << "\n";
+      }
+    }
+
+    report << "\n"
+           << numRegressions << " of " << workloads.size() << " workloads slower than +"
+           << juce::String(threshold * 100.0, 1) << "%\n";
+    return numRegressions;
+  }
+
+ private:
+  static constexpr double sampleRate = 48000.0;
+  static constexpr int blockSize = 512;
+  static constexpr int numConstructions = 50;
+  static constexpr int nameWidth = 44;
+
+  struct ProcessBlockWorkload {
+    const char* name;
+    FeatureCase featureCase;
+    const char* automated;  // a parameter swept once per block, or nullptr
+    bool isDouble;
+  };
+
+  // the paths a session spends most of its time in, the neutral bypass included
+  inline static const ProcessBlockWorkload processBlockWorkloads[] = {
+      {"neutral", {"Stereo", "Width", false, "off", false, true}, nullptr, false},
+      {"matrix", {"Swap", "Width", false, "off", false}, nullptr, false},
+      {"mono", {"Stereo", "Mid/Side", true, "off", false}, nullptr, false},
+      {"bassMono=on", {"Stereo", "Width", false, "on", false}, nullptr, false},
+      {"bassMono=on-48", {"Stereo", "Width", false, "on-48", false}, nullptr, false},
+      {"bassMono=linear", {"Stereo", "Width", false, "linear", false}, nullptr, false},
+      {"dc", {"Stereo", "Width", false, "off", true}, nullptr, false},
+      {"everything", {"Swap", "Mid/Side", true, "on", true}, nullptr, false},
+      {"matrix, gain automated", {"Swap", "Width", false, "off", false}, "gain", false},
+      {"bassMono=on, cutoff automated",
+       {"Stereo", "Width", false, "on", false},
+       "bassMonoFrequency",
+       false},
+      {"bassMono=on, double", {"Stereo", "Width", false, "on", false}, nullptr, true},
+  };
+
+  // median over numRepeats of numConstructions instances, in ns per instance
+  static double timeConstruction(int numRepeats) {
+    std::vector<double> nsPerInstance;
+    for (int repeat = 0; repeat <= numRepeats; ++repeat) {  // the first pass warms up
+      const auto start = juce::Time::getHighResolutionTicks();
+      for (int i = 0; i < numConstructions; ++i) {
+        const auto processor = std::make_unique<UtilityCloneAudioProcessor>();
+      }
+      const auto end = juce::Time::getHighResolutionTicks();
+
+      if (repeat > 0)
+        nsPerInstance.push_back(juce::Time::highResolutionTicksToSeconds(end - start) * 1.0e9 /
+                                numConstructions);
+    }
+    std::sort(nsPerInstance.begin(), nsPerInstance.end());
+    return nsPerInstance[nsPerInstance.size() / 2];
+  }
+
+  // ns per sample of a fixed scalar loop over a block of noise, a one-pole low-pass whose state
+  // carries from sample to sample, so its time follows the clock and the FPU latency of the
+  // machine and not the compiler's choice of vector width
+  static double timeCalibration(int numSamples, int numRepeats) {
+    std::vector<float> block(blockSize);
+    juce::Random random(1);
+    for (auto& sample : block) sample = random.nextFloat() * 2.0f - 1.0f;
+
+    std::vector<double> nsPerSample;
+    float state = 0;
+    for (int repeat = 0; repeat <= numRepeats; ++repeat) {  // the first pass warms up
+      int done = 0;
+      const auto start = juce::Time::getHighResolutionTicks();
+      for (; done < numSamples; done += blockSize)
+        for (const auto sample : block) state += 0.01f * (sample - state);
+      const auto end = juce::Time::getHighResolutionTicks();
+
+      if (repeat > 0)
+        nsPerSample.push_back(juce::Time::highResolutionTicksToSeconds(end - start) * 1.0e9 /
+                              done);
+    }
+    calibrationSink = state;  // keeps the loop from being optimised away
+
+    std::sort(nsPerSample.begin(), nsPerSample.end());
+    return nsPerSample[nsPerSample.size() / 2];
+  }
+
+  inline static volatile float calibrationSink = 0;
+
+  static juce::String format(double value) { return juce::String(value, 2); }
+  static juce::String column(const juce::String& text) { return text.paddedLeft(' ', 14); }
+};
@@ -0,0 +1,201 @@
+/*
+  ==============================================================================
+
+    utility-clone-benchmark: ns per sample of processBlock, as JSON, or with
+    --baseline the slowdown of the gate workloads against an earlier run.
+
+  ==============================================================================
+*/
+
+#include <juce_audio_utils/juce_audio_utils.h>
+
+#include <iostream>
+
+#include "BenchmarkOptions.h"
+#include "FeatureCases.h"
+#include "GateBenchmark.h"
+#include "HostFixtures.h"
+#include "ProcessBlockBenchmark.h"
+#include "StateBenchmark.h"
+
+namespace {
+
+juce::var getSystemInfo(const BenchmarkOptions& options) {
+  auto* info = new juce::DynamicObject();
+  info->setProperty("cpu", juce::SystemStats::getCpuModel());
+  info->setProperty("numCpus", juce::SystemStats::getNumCpus());
+  info->setProperty("os", juce::SystemStats::getOperatingSystemName());
+  info->setProperty("precision", options.isDoublePrecision ? "double" : "float");
+  info->setProperty("samplesPerMeasurement", options.numSamples);
+  info->setProperty("repeats", options.numRepeats);
+  info->setProperty("automated", options.automatedParameter);
+  info->setProperty("input", options.isSilence ? "silence" : "noise");
+  return info;
+}
+
+juce::var runState(const BenchmarkOptions& options) {
+  UtilityCloneAudioProcessor processor;
+  juce::Array<StateBenchmark::Measurement> measurements;
+  const auto measured = StateBenchmark::measure(processor, options.numRepeats, measurements);
+  if (measured.failed()) {
+    std::cerr << measured.getErrorMessage() << std::endl;
+    return {};
+  }
+
+  juce::Array<juce::var> results;
+  for (const auto& measurement : measurements) {
+    auto* result = new juce::DynamicObject();
+    result->setProperty("format", measurement.format);
+    result->setProperty("bytes", measurement.numBytes);
+    result->setProperty("saveNsPerInstance", measurement.saveNsMedian);
+    result->setProperty("loadNsPerInstance", measurement.loadNsMedian);
+    results.add(result);
+  }
+
+  auto* root = new juce::DynamicObject();
+  root->setProperty("benchmark", "state");
+  root->setProperty("system", getSystemInfo(options));
+  root->setProperty("instances", StateBenchmark::numInstances);
+  root->setProperty("results", results);
+  return root;
+}
+
+juce::var runGate(const BenchmarkOptions& options) {
+  double calibration = 0;
+  juce::Array<GateBenchmark::Workload> workloads;
+  const auto measured =
+      GateBenchmark::measure(options.numSamples, options.numRepeats, calibration, workloads);
+  if (measured.failed()) {
+    std::cerr << measured.getErrorMessage() << std::endl;
+    return {};
+  }
+
+  auto* root = new juce::DynamicObject();
+  root->setProperty("benchmark", "gate");
+  root->setProperty("system", getSystemInfo(options));
+  root->setProperty("calibrationNsPerSample", calibration);
+  root->setProperty("results", GateBenchmark::toJson(workloads));
+  return root;
+}
+
+// the report of a --gate run against the baseline, on stdout and in --report; 1 for a slowdown
+int compareWithBaseline(const BenchmarkOptions& options, const juce::var& report) {
+  const auto baseline = juce::JSON::parse(options.baselineFile);
+  if (baseline["benchmark"].toString() != "gate") {
+    std::cerr << options.baselineFile.getFullPathName() << " is not the JSON of a --gate run"
+              << std::endl;
+    return 2;
+  }
+  // a baseline from before the calibration loop has nothing to compare with
+  if (!baseline.hasProperty("calibrationNsPerSample")) {
+    std::cerr << options.baselineFile.getFullPathName()
+              << " has no calibration, write it again with --gate" << std::endl;
+    return 2;
+  }
+
+  juce::Array<GateBenchmark::Workload> workloads;
+  if (const auto* results = report["results"].getArray())
+    for (const auto& result : *results)
+      workloads.add({result["name"].toString(), result["unit"].toString(), result["median"],
+                     result["relative"]});
+
+  juce::String text;
+  const int numRegressions =
+      GateBenchmark::compare(workloads, baseline, options.thresholdPercent / 100.0, text);
+  std::cout << text;
+  if (options.reportFile != juce::File() && !options.reportFile.replaceWithText(text)) {
+    std::cerr << "cannot write " << options.reportFile.getFullPathName() << std::endl;
+    return 1;
+  }
+  return numRegressions > 0 ? 1 : 0;
+}
+
+juce::var run(const BenchmarkOptions& options) {
+  juce::Array<juce::var> results;
+  UtilityCloneAudioProcessor processor;
+  processor.setProcessingPrecision(options.isDoublePrecision
+                                       ? juce::AudioProcessor::doublePrecision
+                                       : juce::AudioProcessor::singlePrecision);
+
+  juce::AudioProcessorParameter* automated = nullptr;
+  if (options.automatedParameter.isNotEmpty()) {
+    automated = findParameter(processor, options.automatedParameter);
+    if (automated == nullptr) {
+      std::cerr << "unknown parameter " << options.automatedParameter << std::endl;
+      return {};
+    }
+  }
+
+  for (const auto& benchmarkCase : FeatureCase::getAll(processor)) {
+    const auto name = benchmarkCase.getName();
+    if (!name.contains(options.filter)) continue;
+    std::cerr << name << std::endl;
+
+    const auto applied = benchmarkCase.apply(processor);
+    if (applied.failed()) {
+      std::cerr << applied.getErrorMessage() << std::endl;
+      return {};
+    }
+
+    for (const auto sampleRate : options.sampleRates) {
+      for (const auto blockSize : options.blockSizes) {
+        const auto measurement =
+            options.isDoublePrecision
+                ? ProcessBlockBenchmark::measure<double>(processor, sampleRate, blockSize,
+                                                         options.numSamples, options.numRepeats,
+                                                         options.isSilence, automated)
+                : ProcessBlockBenchmark::measure<float>(processor, sampleRate, blockSize,
+                                                        options.numSamples, options.numRepeats,
+                                                        options.isSilence, automated);
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("name", name);
+        result->setProperty("channelMode", benchmarkCase.channelMode);
+        result->setProperty("stereoMode", benchmarkCase.stereoMode);
+        result->setProperty("mono", benchmarkCase.isMono);
+        result->setProperty("bassMono", benchmarkCase.bassMono);
+        result->setProperty("dc", benchmarkCase.isDc);
+        result->setProperty("sampleRate", sampleRate);
+        result->setProperty("blockSize", blockSize);
+        result->setProperty("nsPerSample", measurement.nsPerSampleMedian);
+        result->setProperty("nsPerSampleMin", measurement.nsPerSampleMin);
+        result->setProperty("skippedBlocks", measurement.skippedBlocks);
+        result->setProperty("bypassedBlocks", measurement.bypassedBlocks);
+        results.add(result);
+      }
+    }
+  }
+
+  auto* root = new juce::DynamicObject();
+  root->setProperty("benchmark", "processBlock");
+  root->setProperty("system", getSystemInfo(options));
+  root->setProperty("results", results);
+  return root;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const ScopedToolInitialiser initialiser;
+
+  BenchmarkOptions options;
+  const auto parsed = BenchmarkOptions::parse(juce::StringArray(argv + 1, argc - 1), options);
+  if (parsed.failed()) {
+    std::cerr << parsed.getErrorMessage() << "\n\n" << BenchmarkOptions::usage;
+    return 2;
+  }
+
+  const auto report =
+      options.isGate ? runGate(options) : (options.isState ? runState(options) : run(options));
+  if (report.isVoid()) return 1;
+
+  // with a baseline the comparison goes to stdout, the JSON only to --output
+  const auto json = juce::JSON::toString(report);
+  if (options.outputFile == juce::File()) {
+    if (options.baselineFile == juce::File()) std::cout << json << std::endl;
+  } else if (!options.outputFile.replaceWithText(json)) {
+    std::cerr << "cannot write " << options.outputFile.getFullPathName() << std::endl;
+    return 1;
+  }
+  return options.baselineFile == juce::File() ? 0 : compareWithBaseline(options, report);
+}
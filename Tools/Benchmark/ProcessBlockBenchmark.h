@@ -0,0 +1,86 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "PluginProcessor.h"
+
+// Times UtilityCloneAudioProcessor::processBlock on a stereo bus. Every measurement processes
+// fresh noise (or digital silence), each sample once, and reports the time per sample frame (both
+// channels) and the share of blocks the processor skipped as silent or bypassed as neutral.
+// An automated parameter is swept up and down its range once per measurement, set before every
+// block like a host's automation.
+class ProcessBlockBenchmark {
+ public:
+  struct Measurement {
+    double nsPerSampleMedian = 0;
+    double nsPerSampleMin = 0;
+    double skippedBlocks = 0;   // 0 to 1, over every pass
+    double bypassedBlocks = 0;  // 0 to 1, over every pass
+  };
+
+  // numSamples per repeat, rounded up to whole blocks
+  template <typename SampleType>
+  static Measurement measure(UtilityCloneAudioProcessor& processor, double sampleRate,
+                             int blockSize, int numSamples, int numRepeats, bool isSilent = false,
+                             juce::AudioProcessorParameter* automated = nullptr) {
+    constexpr int numChannels = 2;
+    const int numBlocks = (numSamples + blockSize - 1) / blockSize;
+    const int totalSamples = numBlocks * blockSize;
+
+    processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize);
+
+    juce::AudioBuffer<SampleType> source(numChannels, totalSamples);
+    juce::AudioBuffer<SampleType> work(numChannels, totalSamples);
+    source.clear();
+    juce::Random random(1);
+    for (int channel = 0; channel < numChannels && !isSilent; ++channel)
+      for (int i = 0; i < totalSamples; ++i)
+        source.setSample(channel, i, static_cast<SampleType>(random.nextFloat() - 0.5f));
+
+    // views into the work buffer, so only processBlock is inside the timed loop
+    std::vector<juce::AudioBuffer<SampleType>> blocks;
+    blocks.reserve(static_cast<size_t>(numBlocks));
+    for (int block = 0; block < numBlocks; ++block)
+      blocks.emplace_back(work.getArrayOfWritePointers(), numChannels, block * blockSize,
+                          blockSize);
+
+    // triangle from 0 to 1 and back, precomputed so the timed loop only sets it
+    std::vector<float> automation(static_cast<size_t>(numBlocks));
+    for (int block = 0; block < numBlocks; ++block)
+      automation[static_cast<size_t>(block)] =
+          1.0f - std::abs(2.0f * static_cast<float>(block) / static_cast<float>(numBlocks) - 1.0f);
+
+    juce::MidiBuffer midi;
+    std::vector<double> nsPerSample;
+
+    // the first pass only warms up caches and branch predictors
+    for (int repeat = 0; repeat <= numRepeats; ++repeat) {
+      work.makeCopyOf(source, true);
+
+      const auto start = juce::Time::getHighResolutionTicks();
+      for (int block = 0; block < numBlocks; ++block) {
+        if (automated != nullptr)
+          automated->setValueNotifyingHost(automation[static_cast<size_t>(block)]);
+        processor.processBlock(blocks[static_cast<size_t>(block)], midi);
+      }
+      const auto end = juce::Time::getHighResolutionTicks();
+
+      if (repeat > 0)
+        nsPerSample.push_back(juce::Time::highResolutionTicksToSeconds(end - start) * 1.0e9 /
+                              totalSamples);
+    }
+
+    const auto counts = processor.getBlockCounts();
+    const auto numBlocksProcessed = juce::jmax<juce::uint64>(
+        1, counts.processed + counts.skipped + counts.bypassed);
+    processor.releaseResources();
+
+    std::sort(nsPerSample.begin(), nsPerSample.end());
+    return {nsPerSample[nsPerSample.size() / 2], nsPerSample.front(),
+            static_cast<double>(counts.skipped) / static_cast<double>(numBlocksProcessed),
+            static_cast<double>(counts.bypassed) / static_cast<double>(numBlocksProcessed)};
+  }
+};
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+// Times getStateInformation / setStateInformation per instance, as a host saving or loading a
+// session of numInstances plugins: the binary state, and loading the XML state of sessions
+// saved before it. The loads alternate between two states which differ in every parameter, as
+// loading the values an instance already holds skips most of the work; each load is checked to
+// bring back the saved values.
+class StateBenchmark {
+ public:
+  static constexpr int numInstances = 400;
+
+  struct Measurement {
+    juce::String format;
+    int numBytes = 0;
+    double saveNsMedian = 0;  // per instance, 0 when the plugin no longer saves the format
+    double loadNsMedian = 0;
+  };
+
+  static juce::Result measure(juce::AudioProcessor& processor, int numRepeats,
+                              juce::Array<Measurement>& results) {
+    // every parameter off its default, and then every one at the other end of its range
+    auto parameters = processor.getParameters();
+    std::array<std::vector<float>, 2> saved;
+    std::array<juce::MemoryBlock, 2> binary, xml;
+    for (size_t state = 0; state < saved.size(); ++state) {
+      for (int i = 0; i < parameters.size(); ++i) {
+        const auto value = static_cast<float>(i + 1) / (parameters.size() + 1);
+        parameters[i]->setValueNotifyingHost(state == 0 ? value : (value < 0.5f ? 1.0f : 0.0f));
+      }
+      for (auto* parameter : parameters) saved[state].push_back(parameter->getValue());
+      processor.getStateInformation(binary[state]);
+      juce::AudioProcessor::copyXmlToBinary(createLegacyXml(processor), xml[state]);
+    }
+
+    // binary
+    juce::MemoryBlock block;
+    Measurement binaryResult{"binary"};
+    binaryResult.saveNsMedian =
+        time(numRepeats, [&](int) { processor.getStateInformation(block); });
+    binaryResult.numBytes = static_cast<int>(binary[0].getSize());
+    binaryResult.loadNsMedian = time(numRepeats, [&](int instance) {
+      const auto& state = binary[static_cast<size_t>(instance % 2)];
+      processor.setStateInformation(state.getData(), static_cast<int>(state.getSize()));
+    });
+    if (!loadsBack(processor, binary, saved))
+      return juce::Result::fail("the binary state does not load back");
+    results.add(binaryResult);
+
+    // XML, as the parameter tree wrote it
+    Measurement xmlResult{"xml"};
+    xmlResult.numBytes = static_cast<int>(xml[0].getSize());
+    xmlResult.loadNsMedian = time(numRepeats, [&](int instance) {
+      const auto& state = xml[static_cast<size_t>(instance % 2)];
+      processor.setStateInformation(state.getData(), static_cast<int>(state.getSize()));
+    });
+    if (!loadsBack(processor, xml, saved))
+      return juce::Result::fail("the XML state does not load back");
+    results.add(xmlResult);
+
+    return juce::Result::ok();
+  }
+
+ private:
+  // median over numRepeats of numInstances calls, in ns per call; the first pass warms up
+  template <typename Function>
+  static double time(int numRepeats, Function&& call) {
+    std::vector<double> nsPerCall;
+    for (int repeat = 0; repeat <= numRepeats; ++repeat) {
+      const auto start = juce::Time::getHighResolutionTicks();
+      for (int instance = 0; instance < numInstances; ++instance) call(instance);
+      const auto end = juce::Time::getHighResolutionTicks();
+
+      if (repeat > 0)
+        nsPerCall.push_back(juce::Time::highResolutionTicksToSeconds(end - start) * 1.0e9 /
+                            numInstances);
+    }
+    std::sort(nsPerCall.begin(), nsPerCall.end());
+    return nsPerCall[nsPerCall.size() / 2];
+  }
+
+  // <Utility-clone><PARAM id="gain" value="-6.0"/>...</Utility-clone>
+  static juce::XmlElement createLegacyXml(juce::AudioProcessor& processor) {
+    juce::XmlElement root("Utility-clone");
+    for (auto* parameter : processor.getParameters()) {
+      auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter);
+      if (ranged == nullptr) continue;
+      auto* child = root.createNewChildElement("PARAM");
+      child->setAttribute("id", ranged->paramID);
+      child->setAttribute("value", ranged->convertFrom0to1(ranged->getValue()));
+    }
+    return root;
+  }
+
+  // After measure() sets up or times loads, the processor holds the second state, so every load
+  // here changes every parameter, and a load which does nothing is caught.
+  static bool loadsBack(juce::AudioProcessor& processor,
+                        const std::array<juce::MemoryBlock, 2>& states,
+                        const std::array<std::vector<float>, 2>& saved) {
+    auto parameters = processor.getParameters();
+    for (size_t state = 0; state < states.size(); ++state) {
+      processor.setStateInformation(states[state].getData(),
+                                    static_cast<int>(states[state].getSize()));
+      for (int i = 0; i < parameters.size(); ++i)
+        if (std::abs(parameters[i]->getValue() - saved[state][static_cast<size_t>(i)]) > 1.0e-4f)
+          return false;
+    }
+    return true;
+  }
+};
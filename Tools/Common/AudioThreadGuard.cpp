@@ -0,0 +1,211 @@
+#include "AudioThreadGuard.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <new>
+
+#if defined(__GLIBC__)
+#include <dlfcn.h>
+#include <pthread.h>
+#elif defined(_WIN32)
+#include <malloc.h>
+#endif
+
+namespace {
+
+// plain thread_locals with constant initialisers, so they are usable from inside malloc
+thread_local int realtimeDepth = 0;
+thread_local bool isRecording = false;  // the recorder allocates and locks itself
+
+std::atomic<int> numAllocations{0};
+std::atomic<int> numLocks{0};
+
+constexpr int maxCallSites = 8;
+juce::SpinLock callSiteLock;  // not a pthread mutex, so it does not record itself
+juce::StringArray callSites;
+
+void record(std::atomic<int>& counter, const char* what) {
+  if (realtimeDepth == 0 || isRecording) return;
+
+  ++counter;
+  isRecording = true;
+  {
+    const juce::SpinLock::ScopedLockType lock(callSiteLock);
+    if (callSites.size() < maxCallSites)
+      callSites.add(juce::String(what) + " on the audio thread\n" +
+                    juce::SystemStats::getStackBacktrace());
+  }
+  isRecording = false;
+}
+
+}  // namespace
+
+namespace AudioThreadGuard {
+
+ScopedRealtimeSection::ScopedRealtimeSection() { ++realtimeDepth; }
+ScopedRealtimeSection::~ScopedRealtimeSection() { --realtimeDepth; }
+
+void reset() {
+  const juce::SpinLock::ScopedLockType lock(callSiteLock);
+  numAllocations = 0;
+  numLocks = 0;
+  callSites.clear();
+}
+
+Report getReport() {
+  const juce::SpinLock::ScopedLockType lock(callSiteLock);
+  return {numAllocations.load(), numLocks.load(), callSites};
+}
+
+}  // namespace AudioThreadGuard
+
+#if defined(__GLIBC__)
+// glibc keeps its allocator reachable under these names, so the replacements can forward to it.
+// operator new, juce::HeapBlock and std::vector all end up here. The exception specifications
+// have to match glibc's declarations.
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* pointer, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+
+void* malloc(size_t size) __THROW {
+  record(numAllocations, "malloc");
+  return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) __THROW {
+  record(numAllocations, "calloc");
+  return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, size_t size) __THROW {
+  record(numAllocations, "realloc");
+  return __libc_realloc(pointer, size);
+}
+
+void* memalign(size_t alignment, size_t size) __THROW {
+  record(numAllocations, "memalign");
+  return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) __THROW {
+  record(numAllocations, "aligned_alloc");
+  return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** result, size_t alignment, size_t size) __THROW {
+  record(numAllocations, "posix_memalign");
+  *result = __libc_memalign(alignment, size);
+  return *result != nullptr || size == 0 ? 0 : ENOMEM;
+}
+
+int pthread_mutex_lock(pthread_mutex_t* mutex) __THROWNL {
+  // looked up without a function-local static, whose guard could lock a mutex itself
+  using Function = int (*)(pthread_mutex_t*);
+  static std::atomic<Function> next{nullptr};
+  if (next.load(std::memory_order_relaxed) == nullptr)
+    next.store(reinterpret_cast<Function>(dlsym(RTLD_NEXT, "pthread_mutex_lock")),
+               std::memory_order_relaxed);
+
+  record(numLocks, "pthread_mutex_lock");
+  return next.load(std::memory_order_relaxed)(mutex);
+}
+}
+#else
+// Without glibc's names for the allocator only the C++ allocation functions can be replaced:
+// every operator new, including the over-aligned ones juce::dsp and std containers of SIMD
+// types use. malloc called directly and mutex locks go unseen.
+namespace {
+
+void* allocateAligned(std::size_t size, std::align_val_t alignment) {
+  const auto bytes = static_cast<std::size_t>(alignment);
+#if defined(_WIN32)
+  return _aligned_malloc(size > 0 ? size : 1, bytes);
+#else
+  void* pointer = nullptr;
+  const auto result = posix_memalign(&pointer, bytes > sizeof(void*) ? bytes : sizeof(void*),
+                                     size > 0 ? size : 1);
+  return result == 0 ? pointer : nullptr;
+#endif
+}
+
+// what allocateAligned returns has to go back through here, _aligned_malloc has its own free
+void freeAligned(void* pointer) {
+#if defined(_WIN32)
+  _aligned_free(pointer);
+#else
+  std::free(pointer);
+#endif
+}
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+  record(numAllocations, "operator new");
+  if (auto* pointer = std::malloc(size > 0 ? size : 1)) return pointer;
+  throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+  record(numAllocations, "operator new[]");
+  if (auto* pointer = std::malloc(size > 0 ? size : 1)) return pointer;
+  throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  record(numAllocations, "operator new");
+  return std::malloc(size > 0 ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  record(numAllocations, "operator new[]");
+  return std::malloc(size > 0 ? size : 1);
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+  record(numAllocations, "aligned operator new");
+  if (auto* pointer = allocateAligned(size, alignment)) return pointer;
+  throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+  record(numAllocations, "aligned operator new[]");
+  if (auto* pointer = allocateAligned(size, alignment)) return pointer;
+  throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+  record(numAllocations, "aligned operator new");
+  return allocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment,
+                     const std::nothrow_t&) noexcept {
+  record(numAllocations, "aligned operator new[]");
+  return allocateAligned(size, alignment);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept { freeAligned(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { freeAligned(pointer); }
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept {
+  freeAligned(pointer);
+}
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept {
+  freeAligned(pointer);
+}
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept {
+  freeAligned(pointer);
+}
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept {
+  freeAligned(pointer);
+}
+#endif
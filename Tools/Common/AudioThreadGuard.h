@@ -0,0 +1,31 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+// Counts heap allocations and mutex locks made by a thread while it is inside a
+// ScopedRealtimeSection, e.g. around processBlock. The interception lives in
+// AudioThreadGuard.cpp, which replaces malloc / operator new and pthread_mutex_lock for the whole
+// executable, so only the debug tools link it, never the plugin.
+//   - glibc: malloc, calloc, realloc, memalign family and pthread_mutex_lock (std::mutex,
+//     juce::CriticalSection)
+//   - elsewhere: every operator new / new[], plain, nothrow and aligned; no locks
+namespace AudioThreadGuard {
+
+struct Report {
+  int numAllocations = 0;
+  int numLocks = 0;
+  juce::StringArray callSites;  // stack traces of the first few, oldest first
+};
+
+class ScopedRealtimeSection {
+ public:
+  ScopedRealtimeSection();
+  ~ScopedRealtimeSection();
+
+  JUCE_DECLARE_NON_COPYABLE(ScopedRealtimeSection)
+};
+
+void reset();
+Report getReport();
+
+}  // namespace AudioThreadGuard
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "ProcessorParameters.h"
+
+// One combination of the plugin's switches: channel mode x Width or Mid/Side x mono x bass mono
+// off / on / listening with either crossover, or on at the other two slopes x DC. The continuous
+// parameters get fixed non-neutral values, so no stage is skipped as a no-op, except in the one
+// neutral case, which is every parameter at its default (the processor's bypass path).
+struct FeatureCase {
+  juce::String channelMode;  // as in channelModeList
+  juce::String stereoMode;   // as in stereoModeList
+  bool isMono = false;
+  // "off", "on", "on-12", "on-48", "listening", "linear" or "linear-listening"; without a suffix
+  // the slope is 24 dB/oct
+  juce::String bassMono;
+  bool isDc = false;
+  bool isNeutral = false;
+
+  juce::String getName() const {
+    return "channelMode=" + channelMode + ",stereoMode=" + stereoMode +
+           ",mono=" + (isMono ? "on" : "off") + ",bassMono=" + bassMono +
+           ",dc=" + (isDc ? "on" : "off") + (isNeutral ? ",neutral" : "");
+  }
+
+  juce::Result apply(juce::AudioProcessor& processor) const {
+    const std::initializer_list<std::pair<const char*, juce::String>> values{
+        {"gain", isNeutral ? "0" : "-6"},
+        {"pan", isNeutral ? "0" : "-10"},
+        {"stereoWidth", isNeutral ? "100" : "150"},
+        {"stereoMidSide", isNeutral ? "0" : "30"},
+        {"bassMonoFrequency", "120"},
+        {"channelMode", channelMode},
+        {"stereoMode", stereoMode},
+        {"mono", isMono ? "on" : "off"},
+        {"isBassMono", bassMono != "off" ? "on" : "off"},
+        {"isBassMonoListening", bassMono.endsWith("listening") ? "on" : "off"},
+        {"isBassMonoLinearPhase", bassMono.startsWith("linear") ? "on" : "off"},
+        {"bassMonoSlope", bassMono.endsWith("-12")   ? "12 dB/oct"
+                          : bassMono.endsWith("-48") ? "48 dB/oct"
+                                                     : "24 dB/oct"},
+        {"isDc", isDc ? "on" : "off"},
+    };
+
+    for (const auto& [id, text] : values) {
+      const auto result = setParameterFromText(processor, id, text);
+      if (result.failed()) return result;
+    }
+    return juce::Result::ok();
+  }
+
+  static juce::Array<FeatureCase> getAll(juce::AudioProcessor& processor) {
+    juce::Array<FeatureCase> cases;
+    for (const auto& channelMode : getChoices(processor, "channelMode"))
+      for (const auto& stereoMode : getChoices(processor, "stereoMode"))
+        for (const bool isMono : {false, true})
+          for (const auto* bassMono :
+               {"off", "on", "on-12", "on-48", "listening", "linear", "linear-listening"})
+            for (const bool isDc : {false, true})
+              cases.add({channelMode, stereoMode, isMono, bassMono, isDc});
+    cases.add({"Stereo", "Width", false, "off", false, true});
+    return cases;
+  }
+
+ private:
+  static juce::StringArray getChoices(juce::AudioProcessor& processor, const juce::String& id) {
+    if (auto* choice = dynamic_cast<juce::AudioParameterChoice*>(findParameter(processor, id)))
+      return choice->choices;
+    return {};
+  }
+};
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+// What every tool sets up the way a host would, kept in one place so the tools agree.
+
+// For main(): the processor's parameter tree expects a message manager, even though the tools
+// dispatch nothing.
+using ScopedToolInitialiser = juce::ScopedJuceInitialiser_GUI;
+
+// The block sizes hosts actually pass, taken in turn: full, odd, tiny and partial blocks. A tool
+// cycling through them prepares for maxHostBlockSize.
+inline constexpr int hostBlockSizes[] = {512, 1, 300, 511, 64, 17};
+inline constexpr int maxHostBlockSize = 512;
+
+inline int getHostBlockSize(int blockIndex) {
+  return hostBlockSizes[blockIndex % juce::numElementsInArray(hostBlockSizes)];
+}
+
+// The bus layouts a tool covers: mono, stereo, a surround layout of speaker pairs and single
+// speakers, and a discrete one ending in an unpaired channel.
+inline juce::Array<juce::AudioChannelSet> getHostLayouts() {
+  return {juce::AudioChannelSet::mono(), juce::AudioChannelSet::stereo(),
+          juce::AudioChannelSet::create5point1(), juce::AudioChannelSet::discreteChannels(3)};
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+// Parameter access by id for the tools, which drive the processor like a host does.
+inline juce::AudioProcessorParameter* findParameter(juce::AudioProcessor& processor,
+                                                    const juce::String& id) {
+  for (auto* parameter : processor.getParameters())
+    if (auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*>(parameter))
+      if (withID->paramID == id) return parameter;
+  return nullptr;
+}
+
+// text as the plugin shows it: "-6", "on", "Left", "Mid/Side"...
+inline juce::Result setParameterFromText(juce::AudioProcessor& processor, const juce::String& id,
+                                         const juce::String& text) {
+  auto* parameter = findParameter(processor, id);
+  if (parameter == nullptr) return juce::Result::fail("unknown parameter " + id);
+  parameter->setValueNotifyingHost(parameter->getValueForText(text));
+  return juce::Result::ok();
+}
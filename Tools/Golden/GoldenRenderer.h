@@ -0,0 +1,168 @@
+#pragma once
+
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#include "FeatureCases.h"
+#include "HostFixtures.h"
+#include "PluginProcessor.h"
+#include "TestSignals.h"
+
+// Renders a test signal through a new processor set to a feature case, the way a host would: on
+// a bus layout, in float or double, in blocks of changing size, the latency compensated so the
+// output lines up with the input. The result depends on nothing but the code, so a build can be
+// compared with the output of another one sample by sample.
+class GoldenRenderer {
+ public:
+  static constexpr double sampleRate = 48000.0;
+  static constexpr int numSamples = 4096;
+  static constexpr int maxBlockSize = maxHostBlockSize;
+
+  struct Difference {
+    double maxError = 0;
+    double snr = std::numeric_limits<double>::infinity();  // dB, infinite when identical
+  };
+
+  // the output rounded to float, as the golden files hold it
+  template <typename SampleType>
+  static juce::Result render(const FeatureCase& featureCase, TestSignal signal,
+                             const juce::AudioChannelSet& layout,
+                             juce::AudioBuffer<float>& output) {
+    UtilityCloneAudioProcessor processor;
+    juce::AudioProcessor::BusesLayout buses;
+    buses.inputBuses.add(layout);
+    buses.outputBuses.add(layout);
+    if (!processor.setBusesLayout(buses))
+      return juce::Result::fail("unsupported layout " + layout.getDescription());
+
+    processor.setProcessingPrecision(std::is_same_v<SampleType, double>
+                                         ? juce::AudioProcessor::doublePrecision
+                                         : juce::AudioProcessor::singlePrecision);
+    auto result = featureCase.apply(processor);
+    if (result.failed()) return result;
+
+    juce::Array<Ramp> ramps;
+    if (signal == TestSignal::RAMP) {
+      for (const auto& [id, text] : rampTargets) {
+        auto* parameter = findParameter(processor, id);
+        if (parameter == nullptr)
+          return juce::Result::fail("unknown parameter " + juce::String(id));
+        ramps.add({parameter, parameter->getValue(), parameter->getValueForText(text)});
+      }
+    }
+
+    juce::Array<Toggle> toggles;
+    if (signal == TestSignal::TOGGLE) {
+      for (const auto& [id, at] : toggleTimes) {
+        auto* parameter = findParameter(processor, id);
+        if (parameter == nullptr)
+          return juce::Result::fail("unknown parameter " + juce::String(id));
+        toggles.add({parameter, at});
+      }
+    }
+
+    processor.setNonRealtime(true);
+    processor.setRateAndBufferSizeDetails(sampleRate, maxBlockSize);
+    processor.prepareToPlay(sampleRate, maxBlockSize);
+
+    // the input followed by latency samples of silence, of which the first latency are dropped
+    const int latency = processor.getLatencySamples();
+    const auto input = makeTestSignal(signal, layout.size(), numSamples, sampleRate);
+    juce::AudioBuffer<float> padded(input.getNumChannels(), numSamples + latency);
+    padded.clear();
+    for (int channel = 0; channel < input.getNumChannels(); ++channel)
+      padded.copyFrom(channel, 0, input, channel, 0, numSamples);
+    juce::AudioBuffer<SampleType> buffer;
+    buffer.makeCopyOf(padded);
+
+    juce::MidiBuffer midi;
+    int blockIndex = 0;
+    for (int start = 0; start < buffer.getNumSamples(); ++blockIndex) {
+      const int num = juce::jmin(getHostBlockSize(blockIndex), buffer.getNumSamples() - start);
+
+      const auto progress = static_cast<float>(start) / static_cast<float>(numSamples);
+      for (const auto& ramp : ramps)
+        ramp.parameter->setValueNotifyingHost(
+            juce::jmap(juce::jmin(progress, 1.0f), ramp.start, ramp.end));
+      for (auto& toggle : toggles) {
+        if (toggle.isDone || progress < toggle.at) continue;
+        toggle.parameter->setValueNotifyingHost(toggle.parameter->getValue() < 0.5f ? 1.0f : 0.0f);
+        toggle.isDone = true;
+      }
+
+      juce::AudioBuffer<SampleType> block(buffer.getArrayOfWritePointers(),
+                                          buffer.getNumChannels(), start, num);
+      processor.processBlock(block, midi);
+      start += num;
+    }
+    processor.releaseResources();
+
+    padded.makeCopyOf(buffer);
+    output.setSize(padded.getNumChannels(), numSamples);
+    for (int channel = 0; channel < padded.getNumChannels(); ++channel)
+      output.copyFrom(channel, 0, padded, channel, latency, numSamples);
+    return juce::Result::ok();
+  }
+
+  // the largest sample error, and the signal to error ratio over every channel
+  static Difference compare(const juce::AudioBuffer<float>& expected,
+                            const juce::AudioBuffer<float>& actual) {
+    double signalEnergy = 0;
+    double errorEnergy = 0;
+    Difference difference;
+    for (int channel = 0; channel < expected.getNumChannels(); ++channel) {
+      for (int i = 0; i < expected.getNumSamples(); ++i) {
+        const double reference = expected.getSample(channel, i);
+        const double error = actual.getSample(channel, i) - reference;
+        // a NaN has to fail the comparison, not drop out of it
+        const auto magnitude =
+            std::isnan(error) ? std::numeric_limits<double>::infinity() : std::abs(error);
+        difference.maxError = juce::jmax(difference.maxError, magnitude);
+        signalEnergy += reference * reference;
+        errorEnergy += error * error;
+      }
+    }
+    if (errorEnergy > 0)
+      difference.snr = signalEnergy > 0 ? 10.0 * std::log10(signalEnergy / errorEnergy)
+                                        : -std::numeric_limits<double>::infinity();
+    return difference;
+  }
+
+  // The largest error a rewrite of the DSP may make, by what the case runs: the stereo matrix
+  // only rounds differently (< 1e-6 up to +20 dBFS), the recursive filters carry their rounding
+  // on from sample to sample, and the linear phase crossover is an FFT convolution, whose
+  // rounding depends on the FFT engine JUCE picks.
+  static double getTolerance(const FeatureCase& featureCase) {
+    if (featureCase.bassMono.startsWith("linear")) return 1.0e-4;
+    if (featureCase.bassMono != "off" || featureCase.isDc) return 1.0e-5;
+    return 1.0e-6;
+  }
+
+ private:
+  struct Ramp {
+    juce::AudioProcessorParameter* parameter;
+    float start, end;  // normalised
+  };
+
+  struct Toggle {
+    juce::AudioProcessorParameter* parameter;
+    float at;  // progress through the signal
+    bool isDone = false;
+  };
+
+  // where RAMP takes the continuous parameters, from the case's values, one step per block
+  static constexpr std::pair<const char*, const char*> rampTargets[] = {
+      {"gain", "-30"},
+      {"pan", "40"},
+      {"stereoWidth", "50"},
+      {"stereoMidSide", "-30"},
+      {"bassMonoFrequency", "300"}};
+
+  // Where TOGGLE switches Bass Mono and listening, from the case's values, at the first block
+  // past each point. Between them every part of the linear-phase crossover's low band stops and
+  // starts again, which has to pick up the input of the moment, not what it held before.
+  static constexpr std::pair<const char*, float> toggleTimes[] = {
+      {"isBassMono", 0.25f}, {"isBassMonoListening", 0.5f}, {"isBassMono", 0.75f}};
+};
@@ -0,0 +1,185 @@
+/*
+  ==============================================================================
+
+    utility-clone-golden: renders test signals through every feature case and
+    writes them as golden files, or compares them with golden files written by
+    another build.
+
+  ==============================================================================
+*/
+
+#include <juce_audio_utils/juce_audio_utils.h>
+
+#include <iostream>
+
+#include "GoldenRenderer.h"
+#include "HostFixtures.h"
+
+namespace {
+
+constexpr const char* usage =
+    "usage: utility-clone-golden (--write | --check) <folder> [options]\n"
+    "\n"
+    "Renders sine, noise, impulse, DC step, parameter ramp and Bass Mono toggle signals through\n"
+    "every feature combination, on mono, stereo, 5.1 and discrete buses, in float and double.\n"
+    "--write stores the outputs as 32 bit float WAV files, e.g. from the last release; --check\n"
+    "renders them again and compares, printing the max error and the SNR of the outputs beyond\n"
+    "the tolerance of their case. Exits with 1 when any output differs or has no golden file, the\n"
+    "folder holding none included.\n"
+    "\n"
+    "  --write <folder>   write the golden files\n"
+    "  --check <folder>   compare with the golden files in the folder\n"
+    "  --filter <text>    only outputs whose name contains the text, e.g. bassMono=linear, double\n"
+    "  --verbose          print every output, not only the failed ones\n";
+
+// the layout and precision of an output, nothing for stereo in float
+juce::String getVariantName(const juce::AudioChannelSet& layout, bool isDouble) {
+  juce::String name;
+  if (layout != juce::AudioChannelSet::stereo()) name << "," << layout.getDescription();
+  if (isDouble) name << ",double";
+  return name;
+}
+
+juce::File getGoldenFile(const juce::File& folder, const FeatureCase& featureCase,
+                         TestSignal signal, const juce::String& variant) {
+  const auto name =
+      featureCase.getName().replace("/", "-") + "," + getTestSignalName(signal) + variant;
+  return folder.getChildFile(juce::File::createLegalFileName(name) + ".wav");
+}
+
+juce::Result write(const juce::File& file, const juce::AudioBuffer<float>& output) {
+  file.deleteFile();
+  std::unique_ptr<juce::OutputStream> stream(file.createOutputStream());
+  if (stream == nullptr) return juce::Result::fail("cannot create " + file.getFullPathName());
+
+  // 32 bit WAV is float, so the file holds the output exactly
+  std::unique_ptr<juce::AudioFormatWriter> writer(juce::WavAudioFormat().createWriterFor(
+      stream.get(), GoldenRenderer::sampleRate,
+      juce::AudioChannelSet::canonicalChannelSet(output.getNumChannels()), 32, {}, 0));
+  if (writer == nullptr) return juce::Result::fail("cannot write " + file.getFullPathName());
+  stream.release();  // owned by the writer now
+
+  if (!writer->writeFromAudioSampleBuffer(output, 0, output.getNumSamples()))
+    return juce::Result::fail("write error in " + file.getFullPathName());
+  return juce::Result::ok();
+}
+
+juce::Result read(const juce::File& file, juce::AudioBuffer<float>& golden) {
+  if (!file.existsAsFile()) return juce::Result::fail("no golden file " + file.getFullPathName());
+
+  std::unique_ptr<juce::AudioFormatReader> reader(
+      juce::WavAudioFormat().createReaderFor(file.createInputStream().release(), true));
+  if (reader == nullptr) return juce::Result::fail("cannot read " + file.getFullPathName());
+
+  golden.setSize(static_cast<int>(reader->numChannels),
+                 static_cast<int>(reader->lengthInSamples));
+  reader->read(&golden, 0, golden.getNumSamples(), 0, true, true);
+  return juce::Result::ok();
+}
+
+juce::String formatSnr(double snr) {
+  return std::isinf(snr) ? juce::String(snr > 0 ? "inf" : "-inf") : juce::String(snr, 1);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const ScopedToolInitialiser initialiser;
+
+  const juce::StringArray args(argv + 1, argc - 1);
+  const int writeIndex = args.indexOf("--write");
+  const int checkIndex = args.indexOf("--check");
+  const int filterIndex = args.indexOf("--filter");
+  const bool isWrite = writeIndex >= 0;
+  const bool isVerbose = args.contains("--verbose");
+  const auto folderArg = args[isWrite ? writeIndex + 1 : checkIndex + 1];
+  const auto filter = filterIndex >= 0 ? args[filterIndex + 1] : juce::String();
+  if (isWrite == (checkIndex >= 0) || folderArg.isEmpty()) {
+    std::cerr << usage;
+    return 2;
+  }
+
+  const auto folder = juce::File::getCurrentWorkingDirectory().getChildFile(folderArg);
+  if (isWrite && folder.createDirectory().failed()) {
+    std::cerr << "cannot create " << folder.getFullPathName() << std::endl;
+    return 2;
+  }
+  if (!isWrite && folder.findChildFiles(juce::File::findFiles, false, "*.wav").isEmpty()) {
+    // a missing folder must not pass as a check of nothing
+    std::cerr << "no golden files in " << folder.getFullPathName() << ", write them with --write"
+              << std::endl;
+    return 1;
+  }
+
+  juce::Array<FeatureCase> cases;
+  {
+    UtilityCloneAudioProcessor processor;
+    cases = FeatureCase::getAll(processor);
+  }
+
+  int numOutputs = 0;
+  int numFailed = 0;
+  GoldenRenderer::Difference worst;
+
+  for (const auto& layout : getHostLayouts()) {
+    for (const bool isDouble : {false, true}) {
+      const auto variant = getVariantName(layout, isDouble);
+
+      for (const auto& featureCase : cases) {
+        const auto tolerance = GoldenRenderer::getTolerance(featureCase);
+
+        for (const auto signal : allTestSignals) {
+          const auto name = featureCase.getName() + " " + getTestSignalName(signal) + variant;
+          if (!name.contains(filter)) continue;
+          const auto file = getGoldenFile(folder, featureCase, signal, variant);
+          ++numOutputs;
+
+          juce::AudioBuffer<float> output, golden;
+          auto result =
+              isDouble ? GoldenRenderer::render<double>(featureCase, signal, layout, output)
+                       : GoldenRenderer::render<float>(featureCase, signal, layout, output);
+          if (result.wasOk()) result = isWrite ? write(file, output) : read(file, golden);
+          if (result.failed()) {
+            ++numFailed;
+            std::cerr << name << ": " << result.getErrorMessage() << std::endl;
+            continue;
+          }
+          if (isWrite) continue;
+
+          if (golden.getNumChannels() != output.getNumChannels() ||
+              golden.getNumSamples() != output.getNumSamples()) {
+            ++numFailed;
+            std::cerr << name << ": golden file has another length or channel count"
+                      << std::endl;
+            continue;
+          }
+
+          const auto difference = GoldenRenderer::compare(golden, output);
+          worst.maxError = juce::jmax(worst.maxError, difference.maxError);
+          worst.snr = juce::jmin(worst.snr, difference.snr);
+
+          const auto report = name + ": max error " + juce::String(difference.maxError, 9) +
+                              " (tolerance " + juce::String(tolerance, 9) + "), SNR " +
+                              formatSnr(difference.snr) + " dB";
+          if (difference.maxError > tolerance) {
+            ++numFailed;
+            std::cerr << report << std::endl;
+          } else if (isVerbose) {
+            std::cout << report << std::endl;
+          }
+        }
+      }
+    }
+  }
+
+  if (isWrite) {
+    std::cout << numOutputs - numFailed << " of " << numOutputs << " golden files written to "
+              << folder.getFullPathName() << std::endl;
+  } else {
+    std::cout << numOutputs - numFailed << " of " << numOutputs
+              << " outputs match the golden files; worst max error "
+              << juce::String(worst.maxError, 9) << ", worst SNR " << formatSnr(worst.snr)
+              << " dB" << std::endl;
+  }
+  return numFailed > 0 ? 1 : 0;
+}
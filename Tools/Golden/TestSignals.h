@@ -0,0 +1,83 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <cmath>
+
+// The deterministic inputs of utility-clone-golden. Left and right always differ, so the channel
+// mode and the stereo stages change the output; on other layouts the even channels get the left
+// signal and the odd ones the right. RAMP and TOGGLE are the sine again, with the continuous
+// parameters automated over the signal, or Bass Mono and listening switched on and off during it
+// (GoldenRenderer).
+enum class TestSignal { SINE, NOISE, IMPULSE, DC_STEP, RAMP, TOGGLE };
+
+inline const TestSignal allTestSignals[] = {TestSignal::SINE,    TestSignal::NOISE,
+                                            TestSignal::IMPULSE, TestSignal::DC_STEP,
+                                            TestSignal::RAMP,    TestSignal::TOGGLE};
+
+inline juce::String getTestSignalName(TestSignal signal) {
+  switch (signal) {
+    case TestSignal::SINE:
+      return "sine";
+    case TestSignal::NOISE:
+      return "noise";
+    case TestSignal::IMPULSE:
+      return "impulse";
+    case TestSignal::DC_STEP:
+      return "dc-step";
+    case TestSignal::RAMP:
+      return "ramp";
+    default:
+      return "toggle";
+  }
+}
+
+inline juce::AudioBuffer<float> makeTestSignal(TestSignal signal, int numChannels, int numSamples,
+                                               double sampleRate) {
+  juce::AudioBuffer<float> buffer(2, numSamples);
+  buffer.clear();
+  auto* left = buffer.getWritePointer(0);
+  auto* right = buffer.getWritePointer(1);
+
+  switch (signal) {
+    case TestSignal::SINE:
+    case TestSignal::RAMP:
+    case TestSignal::TOGGLE: {
+      // a bass tone below the Bass Mono cutoff and a tone above it, out of phase
+      const auto sine = [sampleRate](int i, double frequency, double phase) {
+        return static_cast<float>(
+            std::sin(juce::MathConstants<double>::twoPi * frequency * i / sampleRate + phase));
+      };
+      for (int i = 0; i < numSamples; ++i) {
+        left[i] = 0.5f * sine(i, 60.0, 0.0) + 0.25f * sine(i, 1000.0, 0.0);
+        right[i] = 0.5f * sine(i, 60.0, 0.5) + 0.25f * sine(i, 1500.0, 1.0);
+      }
+      break;
+    }
+    case TestSignal::NOISE: {
+      juce::Random random(1);
+      for (int i = 0; i < numSamples; ++i) {
+        left[i] = random.nextFloat() - 0.5f;
+        right[i] = random.nextFloat() - 0.5f;
+      }
+      break;
+    }
+    case TestSignal::IMPULSE:
+      for (int i = 0; i < numSamples; i += 1024) left[i] = 1.0f;
+      for (int i = 512; i < numSamples; i += 1024) right[i] = -0.5f;
+      break;
+    case TestSignal::DC_STEP:
+      // up at a quarter, back to silence at three quarters, so the tail rings out too
+      for (int i = numSamples / 4; i < numSamples * 3 / 4; ++i) {
+        left[i] = 0.5f;
+        right[i] = -0.25f;
+      }
+      break;
+  }
+
+  if (numChannels == 2) return buffer;
+  juce::AudioBuffer<float> channels(numChannels, numSamples);
+  for (int channel = 0; channel < numChannels; ++channel)
+    channels.copyFrom(channel, 0, buffer, channel % 2, 0, numSamples);
+  return channels;
+}
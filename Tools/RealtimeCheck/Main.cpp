@@ -0,0 +1,237 @@
+/*
+  ==============================================================================
+
+    utility-clone-rtcheck: fails when processBlock allocates or locks after
+    prepareToPlay, with --simd when a SIMD build of the DSP kernels differs
+    from the scalar one, or with --queue when sample-accurate parameter
+    changes reach the host from processBlock.
+
+  ==============================================================================
+*/
+
+#include <juce_audio_utils/juce_audio_utils.h>
+
+#include <iostream>
+#include <type_traits>
+#include <vector>
+
+#include "AudioThreadGuard.h"
+#include "FeatureCases.h"
+#include "HostFixtures.h"
+#include "PluginProcessor.h"
+#include "SimdCheck.h"
+
+namespace {
+
+constexpr double sampleRate = 48000.0;
+constexpr int maxBlockSize = maxHostBlockSize;
+constexpr int numBlocks = 64;
+
+// Runs numBlocks host blocks with every processBlock call inside a real-time section, switching
+// from one feature case to the next halfway, so ramps and stage changes are covered too.
+template <typename SampleType>
+juce::Result check(const juce::AudioChannelSet& layout, const FeatureCase& from,
+                   const FeatureCase& to, AudioThreadGuard::Report& report) {
+  UtilityCloneAudioProcessor processor;
+  juce::AudioProcessor::BusesLayout buses;
+  buses.inputBuses.add(layout);
+  buses.outputBuses.add(layout);
+  if (!processor.setBusesLayout(buses))
+    return juce::Result::fail("unsupported layout " + layout.getDescription());
+
+  processor.setProcessingPrecision(std::is_same_v<SampleType, double>
+                                       ? juce::AudioProcessor::doublePrecision
+                                       : juce::AudioProcessor::singlePrecision);
+  auto result = from.apply(processor);
+  if (result.failed()) return result;
+
+  processor.setRateAndBufferSizeDetails(sampleRate, maxBlockSize);
+  processor.prepareToPlay(sampleRate, maxBlockSize);
+
+  const int numChannels = layout.size();
+  juce::AudioBuffer<SampleType> buffer(numChannels, maxBlockSize);
+  juce::Random random(1);
+  juce::MidiBuffer midi;
+
+  AudioThreadGuard::reset();
+  for (int i = 0; i < numBlocks; ++i) {
+    if (i == numBlocks / 2) {
+      result = to.apply(processor);
+      if (result.failed()) return result;
+      processor.handlePendingUpdates();  // the message thread's part, outside the check
+    }
+
+    for (int channel = 0; channel < numChannels; ++channel)
+      for (int sample = 0; sample < maxBlockSize; ++sample)
+        buffer.setSample(channel, sample, static_cast<SampleType>(random.nextFloat() - 0.5f));
+
+    const int numSamples = getHostBlockSize(i);
+    juce::AudioBuffer<SampleType> block(buffer.getArrayOfWritePointers(), numChannels,
+                                        numSamples);
+
+    const AudioThreadGuard::ScopedRealtimeSection realtimeSection;
+    processor.processBlock(block, midi);
+  }
+
+  report = AudioThreadGuard::getReport();
+  processor.releaseResources();
+  return juce::Result::ok();
+}
+
+// what a plugin wrapper hears from the processor and passes on to the host
+struct HostListener : juce::AudioProcessorListener {
+  void audioProcessorParameterChanged(juce::AudioProcessor*, int, float) override {
+    ++numParameterChanges;
+  }
+  void audioProcessorChanged(juce::AudioProcessor*, const ChangeDetails&) override {}
+
+  int numParameterChanges = 0;
+};
+
+// Sample-accurate changes through the ParameterChangeQueue: every parameter changes in the first
+// block, and the gain to -inf a quarter into the second. processBlock must not tell the host of
+// any of them, nor allocate or lock, must leave the parameters as they were, and the gain must
+// reach -inf within the block.
+int checkQueue() {
+  UtilityCloneAudioProcessor processor;
+  processor.setRateAndBufferSizeDetails(sampleRate, maxBlockSize);
+  processor.prepareToPlay(sampleRate, maxBlockSize);
+  HostListener listener;
+  processor.addListener(&listener);
+
+  const auto& parameters = processor.getParameters();
+  std::vector<float> values;
+  for (auto* parameter : parameters) values.push_back(parameter->getValue());
+
+  auto& queue = processor.getParameterChangeQueue();
+  juce::Random random(1);
+  for (int i = 0; i < parameters.size(); ++i)
+    queue.push(*parameters[i], random.nextFloat(), i * maxBlockSize / parameters.size());
+
+  juce::AudioBuffer<float> buffer(2, maxBlockSize);
+  juce::MidiBuffer midi;
+  const auto processNoise = [&] {
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+      for (int sample = 0; sample < maxBlockSize; ++sample)
+        buffer.setSample(channel, sample, random.nextFloat() - 0.5f);
+    const AudioThreadGuard::ScopedRealtimeSection realtimeSection;
+    processor.processBlock(buffer, midi);
+  };
+
+  AudioThreadGuard::reset();
+  processNoise();
+  for (int i = 0; i < parameters.size(); ++i)  // back to the values of the second block
+    parameters[i]->setValueNotifyingHost(values[static_cast<size_t>(i)]);
+  processor.handlePendingUpdates();
+  listener.numParameterChanges = 0;
+
+  auto* gain = findParameter(processor, "gain");
+  queue.push(*gain, 0.0f, maxBlockSize / 4);
+  processNoise();
+  const auto report = AudioThreadGuard::getReport();
+  processor.removeListener(&listener);
+
+  juce::StringArray failures;
+  if (listener.numParameterChanges > 0)
+    failures.add(juce::String(listener.numParameterChanges) +
+                 " parameter changes sent to the host");
+  if (report.numAllocations > 0 || report.numLocks > 0)
+    failures.add(juce::String(report.numAllocations) + " allocations, " +
+                 juce::String(report.numLocks) + " locks");
+  for (int i = 0; i < parameters.size(); ++i)
+    if (parameters[i]->getValue() != values[static_cast<size_t>(i)])
+      failures.add(parameters[i]->getName(100) + " changed by the queue");
+  // the gain ramp takes 5 ms, 240 samples
+  if (buffer.getMagnitude(maxBlockSize - 64, 64) > 1.0e-4f)
+    failures.add("the queued gain did not reach -inf within the block");
+
+  for (const auto& failure : failures) std::cerr << "queue: " << failure << std::endl;
+  for (const auto& callSite : report.callSites) std::cerr << "\n" << callSite << std::endl;
+  std::cout << (failures.isEmpty() ? "queued changes: ok" : "queued changes: failed")
+            << std::endl;
+  return failures.isEmpty() ? 0 : 1;
+}
+
+// every kernel build this CPU runs against the scalar build, float and double
+int checkSimd() {
+  std::cout << "this CPU runs " << getSimdLevelName(detectSimdLevel()) << std::endl;
+
+  int numChecks = 0;
+  int numFailed = 0;
+  for (const auto level : SimdCheck::getLevels()) {
+    for (const bool isDouble : {false, true}) {
+      const auto result = isDouble ? SimdCheck::check<double>(level)
+                                   : SimdCheck::check<float>(level);
+      const auto name = juce::String(getSimdLevelName(level)) + (isDouble ? " double" : " float");
+      ++numChecks;
+
+      if (result.failed()) {
+        ++numFailed;
+        std::cerr << name << ": " << result.getErrorMessage() << std::endl;
+      } else {
+        std::cout << name << ": ok" << std::endl;
+      }
+    }
+  }
+
+  std::cout << numChecks - numFailed << " of " << numChecks << " SIMD builds match the scalar one"
+            << std::endl;
+  return numFailed > 0 ? 1 : 0;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const ScopedToolInitialiser initialiser;
+
+  const juce::StringArray args(argv + 1, argc - 1);
+  if (args.contains("--simd")) return checkSimd();
+  if (args.contains("--queue")) return checkQueue();
+
+  const bool isVerbose = args.contains("--verbose");
+  const auto layouts = getHostLayouts();
+
+  juce::Array<FeatureCase> cases;
+  {
+    UtilityCloneAudioProcessor processor;
+    cases = FeatureCase::getAll(processor);
+  }
+
+  int numChecks = 0;
+  int numFailed = 0;
+  juce::StringArray firstCallSites;
+
+  for (const auto& layout : layouts) {
+    for (const bool isDouble : {false, true}) {
+      for (int i = 0; i < cases.size(); ++i) {
+        const auto& from = cases.getReference(i);
+        const auto& to = cases.getReference((i + 1) % cases.size());
+        const auto name = layout.getDescription() + (isDouble ? " double " : " float ") +
+                          from.getName() + " -> " + to.getName();
+
+        AudioThreadGuard::Report report;
+        const auto result = isDouble ? check<double>(layout, from, to, report)
+                                     : check<float>(layout, from, to, report);
+        ++numChecks;
+
+        if (result.failed()) {
+          ++numFailed;
+          std::cerr << name << ": " << result.getErrorMessage() << std::endl;
+        } else if (report.numAllocations > 0 || report.numLocks > 0) {
+          ++numFailed;
+          std::cerr << name << ": " << report.numAllocations << " allocations, "
+                    << report.numLocks << " locks" << std::endl;
+          if (firstCallSites.isEmpty()) firstCallSites = report.callSites;
+        } else if (isVerbose) {
+          std::cout << name << ": ok" << std::endl;
+        }
+      }
+    }
+  }
+
+  for (const auto& callSite : firstCallSites) std::cerr << "\n" << callSite << std::endl;
+
+  std::cout << numChecks - numFailed << " of " << numChecks << " checks real-time safe"
+            << std::endl;
+  return numFailed > 0 ? 1 : 0;
+}
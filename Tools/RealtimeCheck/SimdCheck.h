@@ -0,0 +1,106 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "DSP/SimdDispatch.h"
+
+// Runs a SIMD build of the kernels and the scalar build on the same random blocks and compares
+// the outputs. The matrix and ramp kernels do the same arithmetic per sample, so they must agree
+// to the last bit; the sums of the level meter add their lanes in another order and only agree
+// to float rounding. The lengths cover empty blocks and every tail length of a 16 lane vector.
+class SimdCheck {
+ public:
+  // the builds this binary has and this CPU can run, narrowest first
+  static juce::Array<SimdLevel> getLevels() {
+    juce::Array<SimdLevel> levels;
+    for (auto level : {SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::AVX512})
+      if (level <= detectSimdLevel()) levels.add(level);
+    return levels;
+  }
+
+  template <typename SampleType>
+  static juce::Result check(SimdLevel level) {
+    const auto& reference = *SimdKernels<SampleType>::get(SimdLevel::SCALAR);
+    const auto* kernels = SimdKernels<SampleType>::get(level);
+    if (kernels == nullptr) return juce::Result::fail("not built");
+
+    juce::Random random(1);
+    for (const int numSamples : {0, 1, 2, 3, 5, 7, 8, 9, 15, 16, 17, 31, 33, 63, 64, 65, 4099}) {
+      const auto left = makeBlock<SampleType>(random, numSamples, -1, 1);
+      const auto right = makeBlock<SampleType>(random, numSamples, -1, 1);
+      const StereoMatrix<SampleType> matrix{
+          static_cast<SampleType>(random.nextDouble() * 2 - 1),
+          static_cast<SampleType>(random.nextDouble() * 2 - 1),
+          static_cast<SampleType>(random.nextDouble() * 2 - 1),
+          static_cast<SampleType>(random.nextDouble() * 2 - 1)};
+      const auto at = " at " + juce::String(numSamples) + " samples";
+
+      // applyStereoMatrix
+      {
+        auto expectedL = left, expectedR = right, actualL = left, actualR = right;
+        reference.applyStereoMatrix(expectedL.data(), expectedR.data(), numSamples, matrix);
+        kernels->applyStereoMatrix(actualL.data(), actualR.data(), numSamples, matrix);
+        if (expectedL != actualL || expectedR != actualR)
+          return juce::Result::fail("applyStereoMatrix differs" + at);
+      }
+
+      // applyMidSideRamp
+      {
+        const auto midScale = makeBlock<SampleType>(random, numSamples, 0, 1);
+        const auto sideScale = makeBlock<SampleType>(random, numSamples, 0, 4);
+        const auto gainL = makeBlock<SampleType>(random, numSamples, 0, 2);
+        const auto gainR = makeBlock<SampleType>(random, numSamples, 0, 2);
+        auto expectedL = left, expectedR = right, actualL = left, actualR = right;
+        reference.applyMidSideRamp(expectedL.data(), expectedR.data(), numSamples, matrix,
+                                   midScale.data(), sideScale.data(), gainL.data(), gainR.data());
+        kernels->applyMidSideRamp(actualL.data(), actualR.data(), numSamples, matrix,
+                                  midScale.data(), sideScale.data(), gainL.data(), gainR.data());
+        if (expectedL != actualL || expectedR != actualR)
+          return juce::Result::fail("applyMidSideRamp differs" + at);
+      }
+
+      // getMaxAbs, also on silence with a single sample set, which may fall in the tail
+      {
+        std::vector<SampleType> sparse(static_cast<size_t>(numSamples));
+        if (numSamples > 0) sparse.back() = static_cast<SampleType>(-1.0e-20);
+        const auto isSame = [&](const std::vector<SampleType>& block) {
+          return reference.getMaxAbs(block.data(), numSamples) ==
+                 kernels->getMaxAbs(block.data(), numSamples);
+        };
+        if (!isSame(left) || !isSame(sparse))
+          return juce::Result::fail("getMaxAbs differs" + at);
+      }
+
+      // measureLevels
+      {
+        const auto expected = reference.measureLevels(left.data(), right.data(), numSamples);
+        const auto actual = kernels->measureLevels(left.data(), right.data(), numSamples);
+        if (expected.peakL != actual.peakL || expected.peakR != actual.peakR ||
+            !isClose(expected.sumSquaresL, actual.sumSquaresL, numSamples) ||
+            !isClose(expected.sumSquaresR, actual.sumSquaresR, numSamples) ||
+            !isClose(expected.sumProducts, actual.sumProducts, numSamples))
+          return juce::Result::fail("measureLevels differs" + at);
+      }
+    }
+    return juce::Result::ok();
+  }
+
+ private:
+  template <typename SampleType>
+  static std::vector<SampleType> makeBlock(juce::Random& random, int numSamples, double low,
+                                           double high) {
+    std::vector<SampleType> block(static_cast<size_t>(numSamples));
+    for (auto& sample : block)
+      sample = static_cast<SampleType>(low + random.nextDouble() * (high - low));
+    return block;
+  }
+
+  // a sum of numSamples terms of up to 1, added in float in another order
+  static bool isClose(float expected, float actual, int numSamples) {
+    return std::abs(expected - actual) <= 1.0e-5f * static_cast<float>(std::max(numSamples, 1));
+  }
+};
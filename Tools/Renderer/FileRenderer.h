@@ -0,0 +1,193 @@
+#pragma once
+
+#include <juce_audio_formats/juce_audio_formats.h>
+
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+#include "PluginProcessor.h"
+#include "ProcessorParameters.h"
+#include "RenderOptions.h"
+
+// Renders one audio file through its own processor instance, streaming it in blocks of
+// options.blockSize, so any number of FileRenderers can run on separate threads.
+class FileRenderer {
+ public:
+  FileRenderer(const RenderOptions& renderOptions, const juce::MemoryBlock& pluginState)
+      : options(renderOptions), state(pluginState) {
+    formats.registerBasicFormats();
+  }
+
+  juce::Result render(const juce::File& input, const juce::File& output) {
+    if (input == output) return juce::Result::fail("output would overwrite the input");
+
+    std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(input));
+    if (reader == nullptr) return juce::Result::fail("not a readable WAV / AIFF / FLAC file");
+
+    auto* format = formats.findFormatForFileExtension(output.getFileExtension());
+    if (format == nullptr) return juce::Result::fail("no writer for " + output.getFileExtension());
+
+    const auto layout = reader->getChannelLayout();
+    UtilityCloneAudioProcessor processor;
+    auto result = prepare(processor, layout, reader->sampleRate);
+    if (result.failed()) return result;
+
+    output.deleteFile();
+    std::unique_ptr<juce::OutputStream> stream(output.createOutputStream());
+    if (stream == nullptr) return juce::Result::fail("cannot create " + output.getFullPathName());
+
+    std::unique_ptr<juce::AudioFormatWriter> writer(
+        format->createWriterFor(stream.get(), reader->sampleRate, layout,
+                                getBitDepth(*format, static_cast<int>(reader->bitsPerSample)),
+                                reader->metadataValues, 0));
+    if (writer == nullptr) return juce::Result::fail("cannot write " + format->getFormatName());
+    stream.release();  // owned by the writer now
+
+    result = resolveTimedChanges(processor, reader->sampleRate);
+    if (result.failed()) return result;
+
+    result = processor.isUsingDoublePrecision()
+                 ? renderBlocks(processor, *reader, *writer, doubleBuffer)
+                 : renderBlocks(processor, *reader, *writer, floatBuffer);
+    processor.releaseResources();
+    return result;
+  }
+
+ private:
+  juce::Result prepare(UtilityCloneAudioProcessor& processor, const juce::AudioChannelSet& layout,
+                       double sampleRate) {
+    juce::AudioProcessor::BusesLayout buses;
+    buses.inputBuses.add(layout);
+    buses.outputBuses.add(layout);
+    if (!processor.setBusesLayout(buses))
+      return juce::Result::fail("unsupported channel layout " + layout.getDescription());
+
+    if (state.getSize() > 0)
+      processor.setStateInformation(state.getData(), static_cast<int>(state.getSize()));
+
+    for (const auto& id : options.parameterValues.getAllKeys()) {
+      const auto result = setParameterFromText(processor, id, options.parameterValues[id]);
+      if (result.failed()) return result;
+    }
+
+    processor.setNonRealtime(true);
+    processor.setProcessingPrecision(options.isDoublePrecision
+                                         ? juce::AudioProcessor::doublePrecision
+                                         : juce::AudioProcessor::singlePrecision);
+    processor.setRateAndBufferSizeDetails(sampleRate, options.blockSize);
+    processor.prepareToPlay(sampleRate, options.blockSize);
+    return juce::Result::ok();
+  }
+
+  // --at changes as samples into the input, in time order
+  juce::Result resolveTimedChanges(juce::AudioProcessor& processor, double sampleRate) {
+    changes.clear();
+    nextChange = 0;
+    for (const auto& change : options.timedChanges) {
+      auto* parameter = findParameter(processor, change.id);
+      if (parameter == nullptr) return juce::Result::fail("unknown parameter " + change.id);
+      changes.push_back({juce::roundToInt(change.seconds * sampleRate), parameter,
+                         parameter->getValueForText(change.text)});
+    }
+    std::stable_sort(changes.begin(), changes.end(),
+                     [](const auto& a, const auto& b) { return a.sample < b.sample; });
+    return juce::Result::ok();
+  }
+
+  // Queues the changes which fall into the numSamples from position, and returns how many of
+  // those samples the queue covers sample accurately: all of them, unless it would run out of
+  // room or of splits first. Then the block ends at the change which did not fit, and the caller
+  // renders the rest as the next block.
+  int queueChanges(UtilityCloneAudioProcessor& processor, juce::int64 position, int numSamples) {
+    auto& queue = processor.getParameterChangeQueue();
+    firstQueuedChange = nextChange;
+    int numSplits = 0;
+    int lastOffset = 0;
+    for (; nextChange < changes.size() && changes[nextChange].sample < position + numSamples;
+         ++nextChange) {
+      const auto& change = changes[nextChange];
+      const int offset = static_cast<int>(juce::jmax<juce::int64>(0, change.sample - position));
+      if (offset != lastOffset && numSplits++ == ParameterChangeQueue::maxSplits) return offset;
+      lastOffset = offset;
+
+      if (!queue.push(*change.parameter, change.value, offset)) {
+        if (offset > 0) return offset;
+        // more changes at the first sample than the queue holds: set right before processBlock,
+        // which is just as accurate
+        change.parameter->setValueNotifyingHost(change.value);
+      }
+    }
+    return numSamples;
+  }
+
+  template <typename SampleType>
+  juce::Result renderBlocks(UtilityCloneAudioProcessor& processor,
+                            juce::AudioFormatReader& reader, juce::AudioFormatWriter& writer,
+                            juce::AudioBuffer<SampleType>& buffer) {
+    const int numChannels = static_cast<int>(reader.numChannels);
+    juce::MidiBuffer midi;
+
+    // Latency compensation: the input is followed by latency samples of silence (the reader
+    // zero-fills past its end) and the first latency output samples are dropped, so the output
+    // lines up with the input and has the same length.
+    const int latency = processor.getLatencySamples();
+    const auto renderLength = reader.lengthInSamples + latency;
+
+    int numSamples = 0;
+    for (juce::int64 position = 0; position < renderLength; position += numSamples) {
+      numSamples = queueChanges(
+          processor, position,
+          static_cast<int>(juce::jmin<juce::int64>(options.blockSize, renderLength - position)));
+
+      floatBuffer.setSize(numChannels, numSamples, false, false, true);
+      reader.read(&floatBuffer, 0, numSamples, position, true, true);
+
+      if constexpr (std::is_same_v<SampleType, double>) {
+        buffer.makeCopyOf(floatBuffer, true);
+        processor.processBlock(buffer, midi);
+        floatBuffer.makeCopyOf(buffer, true);
+      } else {
+        processor.processBlock(buffer, midi);
+      }
+      midi.clear();
+      // the queue left the parameters at the start of the block; they go on from its end
+      for (auto i = firstQueuedChange; i < nextChange; ++i)
+        changes[i].parameter->setValueNotifyingHost(changes[i].value);
+      // there is no message loop here: what the processor left to it runs between blocks
+      processor.handlePendingUpdates();
+
+      const int numSkipped =
+          static_cast<int>(juce::jlimit<juce::int64>(0, numSamples, latency - position));
+      if (numSkipped == numSamples) continue;
+
+      if (!writer.writeFromAudioSampleBuffer(floatBuffer, numSkipped, numSamples - numSkipped))
+        return juce::Result::fail("write error at sample " + juce::String(position));
+    }
+
+    return juce::Result::ok();
+  }
+
+  // the requested depth, or the input's, or else the best the format can write
+  int getBitDepth(juce::AudioFormat& format, int inputBitDepth) const {
+    const auto possible = format.getPossibleBitDepths();
+    const int wanted = options.bitDepth > 0 ? options.bitDepth : inputBitDepth;
+    if (possible.contains(wanted)) return wanted;
+    return possible.isEmpty() ? wanted : possible.getLast();
+  }
+
+  const RenderOptions& options;
+  const juce::MemoryBlock& state;
+  juce::AudioFormatManager formats;
+  juce::AudioBuffer<float> floatBuffer;  // what the reader and the writer see
+  juce::AudioBuffer<double> doubleBuffer;
+
+  struct Change {
+    juce::int64 sample;
+    juce::AudioProcessorParameter* parameter;
+    float value;
+  };
+  std::vector<Change> changes;
+  size_t nextChange = 0;
+  size_t firstQueuedChange = 0;  // of the current block
+};
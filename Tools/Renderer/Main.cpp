@@ -0,0 +1,137 @@
+/*
+  ==============================================================================
+
+    utility-clone-render: applies Utility clone to audio files without a host.
+
+  ==============================================================================
+*/
+
+#include <juce_audio_utils/juce_audio_utils.h>
+
+#include <atomic>
+#include <iostream>
+
+#include "FileRenderer.h"
+#include "HostFixtures.h"
+#include "RenderOptions.h"
+
+namespace {
+
+void listParameters() {
+  UtilityCloneAudioProcessor processor;
+  for (auto* parameter : processor.getParameters()) {
+    auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*>(parameter);
+    if (withID == nullptr) continue;
+
+    juce::String values;
+    if (auto* choice = dynamic_cast<juce::AudioParameterChoice*>(parameter))
+      values = choice->choices.joinIntoString(" | ");
+    else if (dynamic_cast<juce::AudioParameterBool*>(parameter) != nullptr)
+      values = "on | off";
+    else if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter))
+      values = juce::String(ranged->getNormalisableRange().start) + " to " +
+               juce::String(ranged->getNormalisableRange().end);
+
+    std::cout << withID->paramID << "  (" << values << ", default "
+              << parameter->getText(parameter->getDefaultValue(), 32) << ")" << std::endl;
+  }
+}
+
+// a state saved by a host, or the XML inside it
+juce::Result loadState(const juce::File& file, juce::MemoryBlock& state) {
+  if (file == juce::File()) return juce::Result::ok();
+  if (!file.loadFileAsData(state))
+    return juce::Result::fail("cannot read " + file.getFullPathName());
+
+  if (auto xml = juce::parseXML(file)) {
+    state.reset();
+    juce::AudioProcessor::copyXmlToBinary(*xml, state);
+  }
+  return juce::Result::ok();
+}
+
+#if UTILITY_CLONE_TRACE
+// the rendering threads have finished, so no event is being written
+juce::Result writeTrace(const juce::File& file) {
+  file.deleteFile();
+  juce::FileOutputStream out(file);
+  if (out.failedToOpen()) return juce::Result::fail("cannot write " + file.getFullPathName());
+  Trace::writeJson(out);
+  out.flush();
+  return out.getStatus();
+}
+#endif
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const ScopedToolInitialiser initialiser;
+
+  RenderOptions options;
+  auto result = RenderOptions::parse(juce::StringArray(argv + 1, argc - 1), options);
+  if (result.failed()) {
+    std::cerr << result.getErrorMessage() << "\n\n" << RenderOptions::usage;
+    return 2;
+  }
+
+  if (options.isListParameters) {
+    listParameters();
+    return 0;
+  }
+
+  juce::MemoryBlock state;
+  result = loadState(options.stateFile, state);
+  if (result.wasOk()) result = options.outputFolder.createDirectory();
+  if (result.failed()) {
+    std::cerr << result.getErrorMessage() << std::endl;
+    return 2;
+  }
+
+  juce::ThreadPool pool(juce::jmin(options.numThreads, options.inputFiles.size()));
+  juce::CriticalSection outputLock;
+  std::atomic<int> numFailed{0};
+  std::atomic<int> numUnfinished{options.inputFiles.size()};
+  juce::WaitableEvent allFinished;  // signalled by the last job
+
+  for (const auto& input : options.inputFiles) {
+    pool.addJob([&, input] {
+#if UTILITY_CLONE_TRACE
+      Trace::claimThread();  // pool threads run several jobs; the first claim holds
+#endif
+      const auto output = options.outputFolder.getChildFile(input.getFileName());
+      const auto fileResult = FileRenderer(options, state).render(input, output);
+
+      {
+        const juce::ScopedLock lock(outputLock);
+        if (fileResult.failed()) {
+          ++numFailed;
+          std::cerr << input.getFullPathName() << ": " << fileResult.getErrorMessage()
+                    << std::endl;
+        } else {
+          std::cout << output.getFullPathName() << std::endl;
+        }
+      }
+
+      if (--numUnfinished == 0) allFinished.signal();
+      return juce::ThreadPoolJob::jobHasFinished;
+    });
+  }
+
+  allFinished.wait();
+
+#if UTILITY_CLONE_TRACE
+  if (options.traceFile != juce::File()) {
+    const auto traced = writeTrace(options.traceFile);
+    if (traced.failed()) {
+      std::cerr << traced.getErrorMessage() << std::endl;
+      return 1;
+    }
+  }
+#endif
+
+  if (numFailed > 0) {
+    std::cerr << numFailed << " of " << options.inputFiles.size() << " files failed" << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include "DSP/Trace.h"
+
+// Command line of utility-clone-render.
+struct RenderOptions {
+  struct TimedChange {
+    double seconds;
+    juce::String id;
+    juce::String text;
+  };
+
+  static constexpr const char* usage =
+      "usage: utility-clone-render [options] <file or folder>...\n"
+      "\n"
+      "Renders WAV / AIFF / FLAC files through Utility clone, one file per thread.\n"
+      "\n"
+      "  -o, --output <folder>   where the rendered files are written (required)\n"
+      "  --state <file>          plugin state to load, as saved by a host or as its XML\n"
+      "  --set <id>=<value>      set a parameter after the state, as shown in the plugin:\n"
+      "                          --set gain=-6 --set invertPhaseL=on --set channelMode=Left\n"
+      "  --at <seconds>:<id>=<value>\n"
+      "                          change a parameter at that time into the file, to the sample:\n"
+      "                          --at 1.5:invertPhaseL=on --at 3:channelMode=Swap\n"
+      "  --list-parameters       print the parameter ids and exit\n"
+      "  --block-size <n>        samples per processBlock call (default 512)\n"
+      "  --threads <n>           files rendered in parallel (default: number of cores)\n"
+      "  --bit-depth <n>         output bit depth (default: same as the input)\n"
+      "  --double                process in double precision\n"
+      "  --trace <file>          write the time of every processing stage as Chrome trace JSON,\n"
+      "                          for a build configured with -DUTILITY_CLONE_TRACE=ON\n";
+
+  juce::Array<juce::File> inputFiles;
+  juce::File outputFolder;
+  juce::File stateFile;
+  juce::File traceFile;  // none when not set
+  juce::StringPairArray parameterValues{false};  // id -> text, in command line order
+  juce::Array<TimedChange> timedChanges;          // in command line order
+  int blockSize = 512;
+  int numThreads = juce::SystemStats::getNumCpus();
+  int bitDepth = 0;  // 0 keeps the bit depth of each input
+  bool isDoublePrecision = false;
+  bool isListParameters = false;
+
+  static juce::Result parse(const juce::StringArray& args, RenderOptions& options) {
+    for (int i = 0; i < args.size(); ++i) {
+      const auto& arg = args[i];
+      const auto nextValue = [&]() -> juce::String { return ++i < args.size() ? args[i] : ""; };
+
+      if (arg == "-o" || arg == "--output") {
+        options.outputFolder = juce::File::getCurrentWorkingDirectory().getChildFile(nextValue());
+      } else if (arg == "--state") {
+        options.stateFile = juce::File::getCurrentWorkingDirectory().getChildFile(nextValue());
+      } else if (arg == "--set") {
+        const auto assignment = nextValue();
+        if (!assignment.contains("="))
+          return juce::Result::fail("--set expects <id>=<value>, got '" + assignment + "'");
+        options.parameterValues.set(assignment.upToFirstOccurrenceOf("=", false, false).trim(),
+                                    assignment.fromFirstOccurrenceOf("=", false, false).trim());
+      } else if (arg == "--at") {
+        const auto change = nextValue();
+        const auto time = change.upToFirstOccurrenceOf(":", false, false).trim();
+        const auto assignment = change.fromFirstOccurrenceOf(":", false, false);
+        if (!change.contains(":") || !assignment.contains("=") ||
+            !time.containsOnly("0123456789.") || time.isEmpty())
+          return juce::Result::fail("--at expects <seconds>:<id>=<value>, got '" + change + "'");
+        options.timedChanges.add({time.getDoubleValue(),
+                                  assignment.upToFirstOccurrenceOf("=", false, false).trim(),
+                                  assignment.fromFirstOccurrenceOf("=", false, false).trim()});
+      } else if (arg == "--trace") {
+        options.traceFile = juce::File::getCurrentWorkingDirectory().getChildFile(nextValue());
+      } else if (arg == "--list-parameters") {
+        options.isListParameters = true;
+      } else if (arg == "--block-size") {
+        options.blockSize = nextValue().getIntValue();
+      } else if (arg == "--threads") {
+        options.numThreads = nextValue().getIntValue();
+      } else if (arg == "--bit-depth") {
+        options.bitDepth = nextValue().getIntValue();
+      } else if (arg == "--double") {
+        options.isDoublePrecision = true;
+      } else if (arg.startsWith("-")) {
+        return juce::Result::fail("unknown option " + arg);
+      } else {
+        addInput(juce::File::getCurrentWorkingDirectory().getChildFile(arg), options.inputFiles);
+      }
+    }
+
+    if (options.isListParameters) return juce::Result::ok();
+    if (options.inputFiles.isEmpty()) return juce::Result::fail("no input files");
+    if (options.outputFolder == juce::File()) return juce::Result::fail("no output folder (-o)");
+    if (options.blockSize <= 0) return juce::Result::fail("--block-size must be positive");
+    if (options.numThreads <= 0) return juce::Result::fail("--threads must be positive");
+    if (options.bitDepth < 0) return juce::Result::fail("--bit-depth must be positive");
+    if (options.stateFile != juce::File() && !options.stateFile.existsAsFile())
+      return juce::Result::fail("state file not found: " + options.stateFile.getFullPathName());
+    if (options.traceFile != juce::File() && !UTILITY_CLONE_TRACE)
+      return juce::Result::fail("--trace needs a build configured with -DUTILITY_CLONE_TRACE=ON");
+
+    return juce::Result::ok();
+  }
+
+ private:
+  // a folder adds the audio files directly inside it
+  static void addInput(const juce::File& file, juce::Array<juce::File>& inputFiles) {
+    if (!file.isDirectory()) {
+      inputFiles.add(file);
+      return;
+    }
+
+    auto children = file.findChildFiles(juce::File::findFiles, false, "*.wav;*.aif;*.aiff;*.flac");
+    children.sort();
+    inputFiles.addArray(children);
+  }
+};